@@ -26,6 +26,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef KAZMATH_AABB2D_H_INCLUDED
 #define KAZMATH_AABB2D_H_INCLUDED
 
+#include <stddef.h>
+
 #include <kazmath/vec2.h>
 #include <kazmath/utility.h>
 
@@ -100,6 +102,14 @@ kmVec2* kmAABB2Centre(const kmAABB2* aabb, kmVec2* pOut);
 kmAABB2* kmAABB2ExpandToContain(kmAABB2* pOut, const kmAABB2* pIn,
                                 const kmAABB2* other);
 
+/**
+ * Computes the bounds of count points into pOut. Points are read
+ * stride bytes apart (0 means tightly packed kmVec2s). If count is 0
+ * pOut is set to an empty (inverted) box. Returns pOut.
+ */
+kmAABB2* kmAABB2FromPoints(kmAABB2* pOut, const kmVec2* points,
+                           size_t stride, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,9 +26,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef KAZMATH_AABB3D_H_INCLUDED
 #define KAZMATH_AABB3D_H_INCLUDED
 
+#include <stddef.h>
+
 #include <kazmath/vec3.h>
 #include <kazmath/utility.h>
 
+struct kmMat4;
+struct kmPlane;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -42,6 +47,19 @@ typedef struct kmAABB3 {
     kmVec3 max; /** The min corner of the box */
 } kmAABB3;
 
+/**
+ * A structure-of-arrays view over a set of AABBs, each
+ * pointer addresses one component of every box.
+ */
+typedef struct kmAABB3SoA {
+    kmScalar* minX;
+    kmScalar* minY;
+    kmScalar* minZ;
+    kmScalar* maxX;
+    kmScalar* maxY;
+    kmScalar* maxZ;
+} kmAABB3SoA;
+
 
 /**
     Initializes the AABB around a central point. If centre is NULL
@@ -75,6 +93,11 @@ kmScalar kmAABB3DiameterY(const kmAABB3* aabb);
 kmScalar kmAABB3DiameterZ(const kmAABB3* aabb);
 kmVec3* kmAABB3Centre(const kmAABB3* aabb, kmVec3* pOut);
 
+/**
+ * Returns the total area of the six faces of the box
+ */
+kmScalar kmAABB3SurfaceArea(const kmAABB3* aabb);
+
 /**
  * @brief kmAABB3ExpandToContain
  * @param pOut - The resulting AABB
@@ -84,6 +107,47 @@ kmVec3* kmAABB3Centre(const kmAABB3* aabb, kmVec3* pOut);
  */
 kmAABB3* kmAABB3ExpandToContain(kmAABB3* pOut, const kmAABB3* pIn, const kmAABB3* other);
 
+/**
+ * Tests the box against the 6 inward facing frustum planes, as filled
+ * in by kmMat4ExtractPlane for KM_PLANE_LEFT to KM_PLANE_FAR. Returns
+ * KM_CONTAINS_ALL, KM_CONTAINS_PARTIAL or KM_CONTAINS_NONE.
+ */
+kmEnum kmAABB3IntersectsFrustum(const kmAABB3* aabb, const struct kmPlane* planes);
+
+/**
+ * Computes the bounds of count points into pOut. Points are read
+ * stride bytes apart (0 means tightly packed kmVec3s) so positions can
+ * be read straight out of interleaved vertex buffers. If count is 0
+ * pOut is set to an empty (inverted) box. Large inputs can be split
+ * into ranges and the partial boxes joined with kmAABB3ExpandToContain.
+ * Returns pOut.
+ */
+kmAABB3* kmAABB3FromPoints(kmAABB3* pOut, const kmVec3* points,
+                           size_t stride, size_t count);
+
+/**
+ * Transforms pIn by the affine matrix pM and stores the AABB enclosing
+ * the result in pOut. Uses Arvo's method: the centre is transformed
+ * as a point and the extents by the absolute value of the upper 3x3,
+ * which gives the same box as transforming all eight corners.
+ * pOut may be pIn. Returns pOut.
+ */
+kmAABB3* kmAABB3Transform(kmAABB3* pOut, const kmAABB3* pIn, const struct kmMat4* pM);
+
+/**
+ * Transforms count boxes, pIn[i] by matrices[i], into pOut[i].
+ * pOut may be pIn. Returns pOut.
+ */
+kmAABB3* kmAABB3TransformArray(kmAABB3* pOut, const kmAABB3* pIn,
+                               const struct kmMat4* matrices, size_t count);
+
+/**
+ * Same as kmAABB3TransformArray but over structure-of-arrays storage.
+ * The component arrays of pOut may alias those of pIn.
+ */
+void kmAABB3TransformSoA(const kmAABB3SoA* pOut, const kmAABB3SoA* pIn,
+                         const struct kmMat4* matrices, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
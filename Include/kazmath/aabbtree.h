@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_AABBTREE_H_INCLUDED
+#define KAZMATH_AABBTREE_H_INCLUDED
+
+#include <kazmath/aabb3.h>
+#include <kazmath/utility.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct kmRay3;
+struct kmPlane;
+
+#define KM_AABB_TREE_NULL_NODE (-1)
+
+/**
+ * A node of a kmAABBTree. Leaves hold a user proxy, internal nodes
+ * always have two children.
+ */
+typedef struct kmAABBTreeNode {
+    kmAABB3 aabb;   /* Fattened bounds for leaves */
+    void* userData;
+    int parent;     /* Next free node while on the free list */
+    int child1;
+    int child2;
+    int height;     /* 0 for leaves, -1 for free nodes */
+} kmAABBTreeNode;
+
+/**
+ * A dynamic bounding volume tree in the style of Box2D and Bullet.
+ * Leaves store fattened boxes so that small movements do not touch the
+ * tree, and the tree is rebalanced with rotations as it changes. All
+ * nodes live in one contiguous pool and are addressed by index.
+ */
+typedef struct kmAABBTree {
+    kmAABBTreeNode* nodes;
+    int root;
+    int nodeCount;
+    int nodeCapacity;
+    int freeList;
+    kmScalar margin;        /* Added around each leaf's box */
+    kmScalar displacementMultiplier; /* Scales the predicted motion */
+} kmAABBTree;
+
+/**
+ * Called for every proxy found by a query. Return KM_FALSE to stop the
+ * query early.
+ */
+typedef kmBool (*kmAABBTreeQueryCallback)(void* context, int proxy);
+
+/**
+ * Prepares an empty tree. Leaves are fattened by margin on every side,
+ * and kmAABBTreeMove stretches them along displacement *
+ * displacementMultiplier.
+ */
+void kmAABBTreeInitialize(kmAABBTree* tree, kmScalar margin,
+                          kmScalar displacementMultiplier);
+void kmAABBTreeRelease(kmAABBTree* tree);
+
+/**
+ * Adds a leaf for aabb and returns its proxy id, which stays valid
+ * until the proxy is removed. Returns KM_AABB_TREE_NULL_NODE, leaving
+ * the tree unchanged, if memory could not be allocated.
+ */
+int kmAABBTreeInsert(kmAABBTree* tree, const kmAABB3* aabb, void* userData);
+void kmAABBTreeRemove(kmAABBTree* tree, int proxy);
+
+/**
+ * Updates a proxy after its object moved to aabb. Nothing happens while
+ * aabb stays inside the fattened box; otherwise the leaf is reinserted,
+ * stretched in the direction of displacement (which may be NULL).
+ * Returns KM_TRUE if the leaf was reinserted.
+ */
+kmBool kmAABBTreeMove(kmAABBTree* tree, int proxy, const kmAABB3* aabb,
+                      const kmVec3* displacement);
+
+void* kmAABBTreeGetUserData(const kmAABBTree* tree, int proxy);
+const kmAABB3* kmAABBTreeGetFatAABB3(const kmAABBTree* tree, int proxy);
+
+/** Returns the height of the tree, 0 for a single leaf */
+int kmAABBTreeGetHeight(const kmAABBTree* tree);
+
+/**
+ * Reports every proxy whose fattened box overlaps aabb.
+ */
+void kmAABBTreeQueryAABB3(const kmAABBTree* tree, const kmAABB3* aabb,
+                          kmAABBTreeQueryCallback callback, void* context);
+
+/**
+ * Reports every proxy whose fattened box is hit by ray.
+ */
+void kmAABBTreeQueryRay3(const kmAABBTree* tree, const struct kmRay3* ray,
+                         kmAABBTreeQueryCallback callback, void* context);
+
+/**
+ * Reports every proxy whose fattened box is at least partly inside the
+ * 6 frustum planes (see kmAABB3IntersectsFrustum). Subtrees found to be
+ * completely inside are reported without further plane tests.
+ */
+void kmAABBTreeQueryFrustum(const kmAABBTree* tree, const struct kmPlane* planes,
+                            kmAABBTreeQueryCallback callback, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_ANIMATION_H_INCLUDED
+#define KAZMATH_ANIMATION_H_INCLUDED
+
+#include <stdint.h>
+
+#include <kazmath/utility.h>
+#include <kazmath/vec3.h>
+#include <kazmath/quaternion.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KM_ANIM_TRANSLATION (kmEnum)0
+#define KM_ANIM_ROTATION (kmEnum)1
+#define KM_ANIM_SCALE (kmEnum)2
+
+/**
+ * One animated property of one bone. Its keys are entries firstKey to
+ * firstKey + keyCount - 1 of the clip's key arrays, in time order.
+ */
+typedef struct kmAnimChannel {
+    uint32_t bone;
+    kmEnum type;
+    uint32_t firstKey;
+    uint32_t keyCount;
+} kmAnimChannel;
+
+/**
+ * An animation clip over caller owned storage. The keys of every
+ * channel are stored back to back: times holds their times and x, y,
+ * z and w their values component by component. w is only read for
+ * rotation channels and may be NULL if there are none.
+ */
+typedef struct kmAnimClip {
+    kmScalar duration;
+    uint32_t boneCount;
+    uint32_t channelCount;
+    const kmAnimChannel* channels;
+    const kmScalar* times;
+    const kmScalar* x;
+    const kmScalar* y;
+    const kmScalar* z;
+    const kmScalar* w;
+} kmAnimClip;
+
+/**
+ * Playback state for a clip. Each channel remembers the key it last
+ * sampled from, so playing forwards only ever steps to the next key;
+ * jumping backwards falls back to a binary search.
+ */
+typedef struct kmAnimSampler {
+    const kmAnimClip* clip;
+    uint32_t* cursors;
+} kmAnimSampler;
+
+/**
+ * Prepares a sampler for clip. Returns KM_FALSE if memory could not be
+ * allocated.
+ */
+kmBool kmAnimSamplerInitialize(kmAnimSampler* sampler, const kmAnimClip* clip);
+void kmAnimSamplerRelease(kmAnimSampler* sampler);
+
+/**
+ * Moves every cursor back to the first key, as after a seek.
+ */
+void kmAnimSamplerReset(kmAnimSampler* sampler);
+
+/**
+ * Samples the clip at time, wrapping it into the clip if loop is
+ * KM_TRUE and clamping it otherwise. When looping, the stretch after a
+ * channel's last key (and before its first) blends from the last key
+ * back to the first, so the clip wraps without a snap. Translations
+ * and scales are interpolated linearly and rotations with
+ * kmQuaternionSlerpFast. The results are written per bone into the three arrays, each
+ * holding clip->boneCount entries; properties without a channel are
+ * left untouched, so the arrays can be preloaded with the bind pose.
+ */
+void kmAnimSamplerSample(kmAnimSampler* sampler, kmScalar time, kmBool loop,
+                         kmVec3* translations, kmQuaternion* rotations, kmVec3* scales);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_ANIMATION_H_INCLUDED */
@@ -0,0 +1,187 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_BVH_H_INCLUDED
+#define KAZMATH_BVH_H_INCLUDED
+
+#include <stdint.h>
+
+#include <kazmath/vec3.h>
+#include <kazmath/aabb3.h>
+#include <kazmath/utility.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct kmRay3;
+
+/**
+ * A 32 byte BVH node. Nodes are stored depth first: the first child
+ * of an interior node immediately follows it and offset holds the index
+ * of the second. For leaves offset is the first entry in the primitive
+ * list and count the number of primitives.
+ */
+typedef struct kmBVHNode {
+    kmAABB3 aabb;
+    uint32_t offset;
+    uint16_t count; /* 0 for interior nodes */
+    uint16_t axis;  /* Split axis of interior nodes */
+} kmBVHNode;
+
+/**
+ * A static bounding volume hierarchy. primitives lists the ids of the
+ * primitives the tree was built over in leaf order.
+ */
+typedef struct kmBVH {
+    kmBVHNode* nodes;
+    uint32_t* primitives;
+    uint32_t nodeCount;
+    uint32_t primitiveCount;
+} kmBVH;
+
+/**
+ * Closest hit returned by the triangle queries. triangle is the
+ * original index of the triangle which was hit.
+ */
+typedef struct kmBVHHit {
+    kmVec3 intersection;
+    kmVec3 normal;
+    kmScalar distance;
+    uint32_t triangle;
+} kmBVHHit;
+
+/**
+ * Called for every primitive whose bounds pass a query. Return KM_FALSE
+ * to stop the query early.
+ */
+typedef kmBool (*kmBVHQueryCallback)(void* context, uint32_t primitive);
+
+/**
+ * Builds bvh over count boxes using binned surface area heuristic
+ * splits. Deep in the tree it falls back to median splits, which keeps
+ * the depth within what the traversals can hold on their stacks.
+ * Returns KM_FALSE if memory could not be allocated.
+ */
+kmBool kmBVHBuild(kmBVH* bvh, const kmAABB3* bounds, uint32_t count);
+
+/**
+ * Builds bvh over an indexed triangle list (3 indices per triangle).
+ * indices is reordered in place to leaf order so that the triangles of
+ * each leaf are contiguous, the original triangle ids are kept in
+ * bvh->primitives. Returns KM_FALSE if memory could not be allocated.
+ */
+kmBool kmBVHBuildTriangles(kmBVH* bvh, const kmVec3* vertices,
+                           uint32_t* indices, uint32_t triangleCount);
+
+void kmBVHRelease(kmBVH* bvh);
+
+#define KM_LBVH_MAX_TASKS 64
+
+/**
+ * A subtree of a linear BVH build which can be completed independently
+ * of the others.
+ */
+typedef struct kmLBVHTask {
+    uint32_t node;
+    uint32_t begin;
+    uint32_t end;
+} kmLBVHTask;
+
+/**
+ * State of a linear BVH build. Primitives are sorted along a 30-bit
+ * Morton curve through their centroids and the hierarchy is split at
+ * the highest differing bit, one primitive per leaf. Since a subtree
+ * over k primitives always takes 2k - 1 nodes, the position of every
+ * subtree is known up front and the tasks can be run on separate
+ * threads.
+ */
+typedef struct kmLBVHBuilder {
+    kmBVH* bvh;
+    const kmAABB3* bounds;
+    uint32_t* codes;
+    kmLBVHTask tasks[KM_LBVH_MAX_TASKS];
+    uint32_t taskCount;
+} kmLBVHBuilder;
+
+/**
+ * Computes and sorts the Morton codes for count boxes and splits the
+ * top of the tree into at most taskCount tasks (capped to
+ * KM_LBVH_MAX_TASKS). Returns KM_FALSE if memory could not be
+ * allocated.
+ */
+kmBool kmLBVHBegin(kmLBVHBuilder* builder, kmBVH* bvh, const kmAABB3* bounds,
+                   uint32_t count, uint32_t taskCount);
+
+/**
+ * Builds the subtree of builder->tasks[task]. Different tasks may be
+ * run concurrently.
+ */
+void kmLBVHBuildTask(const kmLBVHBuilder* builder, uint32_t task);
+
+/**
+ * Fits the nodes above the tasks once they are all done and releases
+ * the scratch memory. The kmBVH is then ready for the usual queries.
+ */
+void kmLBVHEnd(kmLBVHBuilder* builder);
+
+/**
+ * Convenience wrapper running a whole linear build on the calling
+ * thread.
+ */
+kmBool kmBVHBuildLinear(kmBVH* bvh, const kmAABB3* bounds, uint32_t count);
+
+/**
+ * Reports every primitive whose leaf bounds overlap aabb.
+ */
+void kmBVHQueryAABB3(const kmBVH* bvh, const kmAABB3* aabb,
+                     kmBVHQueryCallback callback, void* context);
+
+/**
+ * Reports every primitive in a leaf hit by ray.
+ */
+void kmBVHQueryRay3(const kmBVH* bvh, const struct kmRay3* ray,
+                    kmBVHQueryCallback callback, void* context);
+
+/**
+ * Finds the closest triangle hit by ray. vertices and indices must be
+ * the buffers passed to kmBVHBuildTriangles. Hits follow the rules of
+ * kmRay3IntersectTriangle.
+ */
+kmBool kmBVHIntersectTriangles(const kmBVH* bvh, const struct kmRay3* ray,
+                               const kmVec3* vertices, const uint32_t* indices,
+                               kmBVHHit* hit);
+
+/**
+ * Returns KM_TRUE as soon as any triangle is hit by ray.
+ */
+kmBool kmBVHIntersectTrianglesAny(const kmBVH* bvh, const struct kmRay3* ray,
+                                  const kmVec3* vertices, const uint32_t* indices);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_DUAL_QUATERNION_H_INCLUDED
+#define KAZMATH_DUAL_QUATERNION_H_INCLUDED
+
+#include <kazmath/utility.h>
+#include <kazmath/vec3.h>
+#include <kazmath/quaternion.h>
+
+struct kmMat4;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A rigid transform stored as real + dual * e, where real is the
+ * rotation and dual is half the translation multiplied by the rotation.
+ * Transforms compose like kmMat4: a * b applies b first.
+ */
+typedef struct kmDualQuaternion {
+    kmQuaternion real;
+    kmQuaternion dual;
+} kmDualQuaternion;
+
+kmDualQuaternion* kmDualQuaternionIdentity(kmDualQuaternion* pOut);
+
+/**
+ * Builds the transform that rotates by rotation and then translates
+ * by translation. rotation must be normalized.
+ */
+kmDualQuaternion* kmDualQuaternionFromRotationTranslation(kmDualQuaternion* pOut,
+                                                          const kmQuaternion* rotation,
+                                                          const kmVec3* translation);
+
+/**
+ * Builds a dual quaternion from the rotation and translation of pIn.
+ * Any scale or shear in pIn is lost.
+ */
+kmDualQuaternion* kmDualQuaternionFromMat4(kmDualQuaternion* pOut, const struct kmMat4* pIn);
+
+kmQuaternion* kmDualQuaternionGetRotation(kmQuaternion* pOut, const kmDualQuaternion* pIn);
+kmVec3* kmDualQuaternionGetTranslation(kmVec3* pOut, const kmDualQuaternion* pIn);
+struct kmMat4* kmDualQuaternionToMat4(struct kmMat4* pOut, const kmDualQuaternion* pIn);
+
+kmDualQuaternion* kmDualQuaternionMultiply(kmDualQuaternion* pOut, const kmDualQuaternion* a,
+                                           const kmDualQuaternion* b);
+
+/**
+ * Returns the inverse of a unit dual quaternion.
+ */
+kmDualQuaternion* kmDualQuaternionConjugate(kmDualQuaternion* pOut, const kmDualQuaternion* pIn);
+
+/**
+ * Scales pIn to unit length and removes the part of the dual that is
+ * parallel to the real, so that the result is a rigid transform again.
+ * pIn must not be zero.
+ */
+kmDualQuaternion* kmDualQuaternionNormalize(kmDualQuaternion* pOut, const kmDualQuaternion* pIn);
+
+/**
+ * Transforms a point by a unit dual quaternion.
+ */
+kmVec3* kmDualQuaternionTransformPoint(kmVec3* pOut, const kmDualQuaternion* dq, const kmVec3* point);
+
+/**
+ * Rotates a normal (or any direction) by a unit dual quaternion.
+ */
+kmVec3* kmDualQuaternionTransformNormal(kmVec3* pOut, const kmDualQuaternion* dq, const kmVec3* normal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_DUAL_QUATERNION_H_INCLUDED */
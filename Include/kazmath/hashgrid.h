@@ -0,0 +1,117 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_HASHGRID_H_INCLUDED
+#define KAZMATH_HASHGRID_H_INCLUDED
+
+#include <stdint.h>
+
+#include <kazmath/aabb3.h>
+#include <kazmath/utility.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A slot of the kmHashGrid cell table. The entities overlapping the
+ * cell are entries[start] to entries[start + count - 1]; a count of 0
+ * marks an empty slot.
+ */
+typedef struct kmHashGridCell {
+    int32_t x, y, z;
+    uint32_t start;
+    uint32_t count;
+} kmHashGridCell;
+
+/**
+ * A uniform grid of cubic cells, hashed on the integer cell coordinates
+ * so that only occupied cells take memory. The grid is rebuilt in bulk
+ * from an array of boxes: the cells are counted into an open addressed
+ * table first and the entity indices are then scattered into one array
+ * ordered by cell. Storage is kept between rebuilds.
+ *
+ * The boxes passed to kmHashGridBuild are referenced, not copied, and
+ * must stay valid while the grid is queried.
+ */
+typedef struct kmHashGrid {
+    kmScalar cellSize;
+    kmScalar invCellSize;
+    const kmAABB3* boxes;
+    uint32_t boxCount;
+    kmHashGridCell* cells;
+    uint32_t cellCapacity;  /* Always a power of two */
+    uint32_t* entries;
+    uint32_t entryCount;
+    uint32_t entryCapacity;
+} kmHashGrid;
+
+/**
+ * Called for every entity found by a query. Return KM_FALSE to stop the
+ * query early.
+ */
+typedef kmBool (*kmHashGridQueryCallback)(void* context, uint32_t entity);
+
+/**
+ * Called for every overlapping pair, with a < b. Return KM_FALSE to
+ * stop early.
+ */
+typedef kmBool (*kmHashGridPairCallback)(void* context, uint32_t a, uint32_t b);
+
+void kmHashGridInitialize(kmHashGrid* grid, kmScalar cellSize);
+void kmHashGridRelease(kmHashGrid* grid);
+
+/**
+ * Replaces the contents of the grid with count boxes. Returns KM_FALSE
+ * if memory could not be allocated or the boxes would be stored in more
+ * than 2^30 cells between them, leaving the grid empty.
+ */
+kmBool kmHashGridBuild(kmHashGrid* grid, const kmAABB3* boxes, uint32_t count);
+
+/**
+ * Reports each entity whose box overlaps aabb exactly once. aabb may
+ * be arbitrarily large or infinite; regions covering more cells than
+ * the table holds are answered by scanning the table.
+ */
+void kmHashGridQueryAABB3(const kmHashGrid* grid, const kmAABB3* aabb,
+                          kmHashGridQueryCallback callback, void* context);
+
+/**
+ * Reports each entity whose box lies within radius of centre.
+ */
+void kmHashGridQueryRadius(const kmHashGrid* grid, const kmVec3* centre, kmScalar radius,
+                           kmHashGridQueryCallback callback, void* context);
+
+/**
+ * Reports every pair of overlapping boxes once. Only entities sharing
+ * a cell are passed to kmAABB3IntersectsAABB.
+ */
+void kmHashGridQueryPairs(const kmHashGrid* grid, kmHashGridPairCallback callback, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_HASHGRID_H_INCLUDED */
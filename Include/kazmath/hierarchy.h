@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_HIERARCHY_H_INCLUDED
+#define KAZMATH_HIERARCHY_H_INCLUDED
+
+#include <kazmath/utility.h>
+#include <kazmath/vec3.h>
+#include <kazmath/quaternion.h>
+#include <kazmath/mat4.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KM_HIERARCHY_NO_PARENT -1
+
+/**
+ * A transform hierarchy stored flat, one entry per node in each array.
+ * Nodes are kept in parent-first order (parents[i] < i), so one pass
+ * from the front updates every world matrix with no recursion.
+ *
+ * translations, rotations and scales hold each node's local transform
+ * and may be written directly, followed by kmTransformHierarchyMarkDirty.
+ * world and inverseWorld hold the results of the last update.
+ */
+typedef struct kmTransformHierarchy {
+    int count;
+    int capacity;
+    int* parents;
+    kmVec3* translations;
+    kmQuaternion* rotations;
+    kmVec3* scales;
+    kmMat4* world;
+    kmMat4* inverseWorld;
+    kmUchar* dirty;
+} kmTransformHierarchy;
+
+void kmTransformHierarchyInitialize(kmTransformHierarchy* hierarchy);
+void kmTransformHierarchyRelease(kmTransformHierarchy* hierarchy);
+
+/**
+ * Makes room for capacity nodes. Returns KM_FALSE if memory could not
+ * be allocated.
+ */
+kmBool kmTransformHierarchyReserve(kmTransformHierarchy* hierarchy, int capacity);
+
+/**
+ * Appends a node below parent, which must already have been added, or
+ * KM_HIERARCHY_NO_PARENT for a root. Adding subtrees depth first keeps
+ * each subtree contiguous, see kmTransformHierarchyUpdateRange. Returns
+ * the index of the node, or -1 if memory could not be allocated.
+ */
+int kmTransformHierarchyAdd(kmTransformHierarchy* hierarchy, int parent,
+                            const kmVec3* translation, const kmQuaternion* rotation,
+                            const kmVec3* scale);
+
+/**
+ * Replaces the local transform of node and marks it dirty.
+ */
+void kmTransformHierarchySetLocal(kmTransformHierarchy* hierarchy, int node,
+                                  const kmVec3* translation, const kmQuaternion* rotation,
+                                  const kmVec3* scale);
+
+void kmTransformHierarchyMarkDirty(kmTransformHierarchy* hierarchy, int node);
+
+/**
+ * Recomputes the world and inverse world matrices of every dirty node
+ * and every node below one, then clears the dirty flags. Returns the
+ * number of nodes updated.
+ */
+int kmTransformHierarchyUpdate(kmTransformHierarchy* hierarchy);
+
+/**
+ * Updates nodes begin to end - 1 without clearing their dirty flags.
+ * Ranges whose nodes only have parents inside the range or already up
+ * to date (such as two sibling subtrees added depth first, once their
+ * ancestors are done) share nothing and may run on separate threads.
+ * Call kmTransformHierarchyClearDirty once every range is done.
+ */
+int kmTransformHierarchyUpdateRange(kmTransformHierarchy* hierarchy, int begin, int end);
+
+void kmTransformHierarchyClearDirty(kmTransformHierarchy* hierarchy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_HIERARCHY_H_INCLUDED */
@@ -33,11 +33,25 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <kazmath/mat4.h>
 #include <kazmath/utility.h>
 #include <kazmath/quaternion.h>
+#include <kazmath/dualquaternion.h>
+#include <kazmath/spline.h>
 #include <kazmath/plane.h>
 #include <kazmath/aabb2.h>
 #include <kazmath/aabb3.h>
+#include <kazmath/sphere.h>
+#include <kazmath/obb3.h>
+#include <kazmath/aabbtree.h>
+#include <kazmath/bvh.h>
+#include <kazmath/hashgrid.h>
+#include <kazmath/sweepprune.h>
+#include <kazmath/looseoctree.h>
+#include <kazmath/animation.h>
+#include <kazmath/quantize.h>
+#include <kazmath/skin.h>
+#include <kazmath/hierarchy.h>
 #include <kazmath/ray2.h>
 #include <kazmath/ray3.h>
+#include <kazmath/ray3packet.h>
 #include <kazmath/3ds.h>
 
 #endif /* KAZMATH_H_INCLUDED */
@@ -0,0 +1,155 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_LOOSEOCTREE_H_INCLUDED
+#define KAZMATH_LOOSEOCTREE_H_INCLUDED
+
+#include <kazmath/aabb3.h>
+#include <kazmath/utility.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct kmRay3;
+struct kmPlane;
+
+#define KM_LOOSE_OCTREE_NULL (-1)
+#define KM_LOOSE_OCTREE_MAX_DEPTH 16
+
+/**
+ * A node of a kmLooseOctree. Children are indexed by their octant,
+ * bit 0 for +x, bit 1 for +y and bit 2 for +z.
+ */
+typedef struct kmLooseOctreeNode {
+    kmAABB3 looseBounds;
+    int parent;         /* Next free node while on the free list */
+    int children[8];
+    int firstObject;
+    int objectCount;    /* Objects in this node and all below it */
+    int depth;
+} kmLooseOctreeNode;
+
+/**
+ * An object stored in a kmLooseOctree, linked into its node's list.
+ */
+typedef struct kmLooseOctreeObject {
+    kmAABB3 aabb;
+    void* userData;
+    int node;           /* KM_LOOSE_OCTREE_NULL while free */
+    int prev;
+    int next;           /* Next free object while on the free list */
+} kmLooseOctreeObject;
+
+/**
+ * A loose octree over a cubic region. Every node's bounds are its cell
+ * scaled by looseness, so an object only needs its centre inside a
+ * cell and its size below a limit to fit there. That lets the depth
+ * and cell for an object be computed directly from its size and
+ * position, and lets objects move freely while they stay inside the
+ * loose bounds of their node.
+ *
+ * Nodes and objects live in pools that grow on demand and can be
+ * reserved up front with kmLooseOctreeReserve so that later inserts,
+ * moves and removals do not allocate. Objects whose centre lies
+ * outside the region are kept at the root, which queries always visit.
+ */
+typedef struct kmLooseOctree {
+    kmLooseOctreeNode* nodes;
+    int nodeCapacity;
+    int freeNodes;
+    kmLooseOctreeObject* objects;
+    int objectCapacity;
+    int freeObjects;
+    int root;
+    kmVec3 centre;
+    kmScalar halfSize;
+    kmScalar looseness;
+    int maxDepth;
+} kmLooseOctree;
+
+/**
+ * Called for every object found by a query. Return KM_FALSE to stop the
+ * query early.
+ */
+typedef kmBool (*kmLooseOctreeQueryCallback)(void* context, int proxy);
+
+/**
+ * Prepares an empty tree over the cube at centre with the given half
+ * size. looseness must be greater than 1 (2 is typical) and maxDepth is
+ * capped to KM_LOOSE_OCTREE_MAX_DEPTH.
+ */
+void kmLooseOctreeInitialize(kmLooseOctree* tree, const kmVec3* centre, kmScalar halfSize,
+                             kmScalar looseness, int maxDepth);
+void kmLooseOctreeRelease(kmLooseOctree* tree);
+
+/**
+ * Grows the pools to hold at least nodes nodes and objects objects.
+ * Returns KM_FALSE if memory could not be allocated.
+ */
+kmBool kmLooseOctreeReserve(kmLooseOctree* tree, int nodes, int objects);
+
+/**
+ * Adds an object and returns its proxy id, or KM_LOOSE_OCTREE_NULL if
+ * memory could not be allocated.
+ */
+int kmLooseOctreeInsert(kmLooseOctree* tree, const kmAABB3* aabb, void* userData);
+void kmLooseOctreeRemove(kmLooseOctree* tree, int proxy);
+
+/**
+ * Updates an object after it moved to aabb. The object stays in its
+ * node while aabb fits inside the node's loose bounds; otherwise it is
+ * reinserted. Returns KM_TRUE if it was reinserted.
+ */
+kmBool kmLooseOctreeMove(kmLooseOctree* tree, int proxy, const kmAABB3* aabb);
+
+void* kmLooseOctreeGetUserData(const kmLooseOctree* tree, int proxy);
+const kmAABB3* kmLooseOctreeGetAABB3(const kmLooseOctree* tree, int proxy);
+
+/**
+ * Reports every object whose box overlaps aabb.
+ */
+void kmLooseOctreeQueryAABB3(const kmLooseOctree* tree, const kmAABB3* aabb,
+                             kmLooseOctreeQueryCallback callback, void* context);
+
+/**
+ * Reports every object whose box is hit by ray.
+ */
+void kmLooseOctreeQueryRay3(const kmLooseOctree* tree, const struct kmRay3* ray,
+                            kmLooseOctreeQueryCallback callback, void* context);
+
+/**
+ * Reports every object whose box is at least partly inside the 6
+ * frustum planes (see kmAABB3IntersectsFrustum). Nodes found to be
+ * completely inside are reported without further plane tests.
+ */
+void kmLooseOctreeQueryFrustum(const kmLooseOctree* tree, const struct kmPlane* planes,
+                               kmLooseOctreeQueryCallback callback, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_LOOSEOCTREE_H_INCLUDED */
@@ -26,6 +26,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef MAT4_H_INCLUDED
 #define MAT4_H_INCLUDED
 
+#include <stddef.h>
+
 #include <kazmath/utility.h>
 
 struct kmVec3;
@@ -138,6 +140,20 @@ kmMat4* kmMat4RotationQuaternion(kmMat4* pOut, const struct kmQuaternion* pQ);
 kmMat4* kmMat4RotationTranslation(kmMat4* pOut, const struct kmMat3* rotation,
                                   const struct kmVec3* translation);
 
+/**
+ * Builds translation * rotation * scale in one pass, without the
+ * intermediate matrices or matrix products. Returns pOut.
+ */
+kmMat4* kmMat4FromTRS(kmMat4* pOut, const struct kmVec3* translation,
+                      const struct kmQuaternion* rotation, const struct kmVec3* scale);
+
+/**
+ * kmMat4FromTRS over count transforms.
+ */
+void kmMat4FromTRSArray(kmMat4* pOut, const struct kmVec3* translations,
+                        const struct kmQuaternion* rotations, const struct kmVec3* scales,
+                        size_t count);
+
 /** Builds a scaling matrix */
 kmMat4* kmMat4Scaling(kmMat4* pOut, const kmScalar x, const kmScalar y,
                       const kmScalar z);
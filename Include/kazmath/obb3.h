@@ -0,0 +1,110 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_OBB3_H_INCLUDED
+#define KAZMATH_OBB3_H_INCLUDED
+
+#include <stddef.h>
+
+#include <kazmath/vec3.h>
+#include <kazmath/plane.h>
+#include <kazmath/utility.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct kmAABB3;
+struct kmMat4;
+
+/**
+ * A structure that represents an oriented bounding box. The axes are
+ * unit length and mutually perpendicular, halfExtents holds the
+ * distance from the centre to each face along the matching axis.
+ */
+typedef struct kmOBB3 {
+    kmVec3 centre;
+    kmVec3 axes[3];
+    kmVec3 halfExtents;
+} kmOBB3;
+
+/**
+ * Sets pOut to the box covering aabb, aligned to the world axes.
+ * Returns pOut.
+ */
+kmOBB3* kmOBB3FromAABB3(kmOBB3* pOut, const struct kmAABB3* aabb);
+
+/**
+ * Fits a box around count points. The axes are the eigenvectors of the
+ * points' covariance matrix (principal component analysis), which
+ * follows the spread of the points far better than the world axes.
+ * Points are read stride bytes apart (0 means tightly packed kmVec3s).
+ * Returns pOut.
+ */
+kmOBB3* kmOBB3FromPoints(kmOBB3* pOut, const kmVec3* points, size_t stride,
+                         size_t count);
+
+/**
+ * Transforms pIn by pM and stores the result in pOut. Exact for
+ * rotations, translations and uniform scales. Under shears and
+ * non-uniform scales the axes are re-orthonormalized and the extents
+ * refit so the result still contains the transformed box. pM must be
+ * invertible. pOut may be pIn. Returns pOut.
+ */
+kmOBB3* kmOBB3Transform(kmOBB3* pOut, const kmOBB3* pIn, const struct kmMat4* pM);
+
+/**
+ * Stores the smallest AABB containing obb in pOut. Returns pOut.
+ */
+struct kmAABB3* kmOBB3ToAABB3(struct kmAABB3* pOut, const kmOBB3* obb);
+
+kmBool kmOBB3ContainsPoint(const kmOBB3* obb, const kmVec3* point);
+
+/**
+ * Separating axis test between two boxes, checking the 3 face axes of
+ * each box and the 9 pairwise edge cross products.
+ */
+kmBool kmOBB3IntersectsOBB3(const kmOBB3* a, const kmOBB3* b);
+kmBool kmOBB3IntersectsAABB3(const kmOBB3* obb, const struct kmAABB3* aabb);
+
+/**
+ * Returns POINT_INFRONT_OF_PLANE or POINT_BEHIND_PLANE if the box is
+ * entirely on one side of the plane, and POINT_ON_PLANE if the plane
+ * cuts through it. The plane is assumed to be normalized.
+ */
+KM_POINT_CLASSIFICATION kmOBB3ClassifyPlane(const kmOBB3* obb, const kmPlane* plane);
+
+/**
+ * Tests the box against the 6 inward facing frustum planes, as filled
+ * in by kmMat4ExtractPlane for KM_PLANE_LEFT to KM_PLANE_FAR. Returns
+ * KM_CONTAINS_ALL, KM_CONTAINS_PARTIAL or KM_CONTAINS_NONE.
+ */
+kmEnum kmOBB3IntersectsFrustum(const kmOBB3* obb, const kmPlane* planes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
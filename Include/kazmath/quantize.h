@@ -0,0 +1,95 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_QUANTIZE_H_INCLUDED
+#define KAZMATH_QUANTIZE_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kazmath/utility.h>
+#include <kazmath/vec3.h>
+#include <kazmath/quaternion.h>
+#include <kazmath/aabb3.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An IEEE 754 binary16 value. Conversions round to nearest even.
+ * Normal values keep a relative error of at most 2^-11 (4.9e-4),
+ * values below 6.1e-5 an absolute error of at most 2^-25, and values
+ * of 65520 or more become infinity.
+ */
+typedef uint16_t kmHalf;
+
+kmHalf kmHalfFromScalar(kmScalar s);
+kmScalar kmHalfToScalar(kmHalf h);
+
+void kmHalfFromScalarArray(kmHalf* pOut, const kmScalar* in, size_t count);
+void kmHalfToScalarArray(kmScalar* pOut, const kmHalf* in, size_t count);
+
+/**
+ * Smallest three quaternion encoding. The largest component is dropped
+ * and rebuilt from the unit length, the other three are stored in the
+ * range [-1/sqrt(2), 1/sqrt(2)]. q and -q are the same rotation, so
+ * the result may come back negated. The input must be normalized.
+ *
+ * The 48 bit form stores 15 bits per component in three words; each
+ * component of the decoded quaternion is within 8e-5 of the original.
+ * The 32 bit form stores 10 bits per component; the error is within
+ * 2.5e-3.
+ */
+void kmQuaternionPack48(uint16_t pOut[3], const kmQuaternion* pIn);
+kmQuaternion* kmQuaternionUnpack48(kmQuaternion* pOut, const uint16_t pIn[3]);
+
+uint32_t kmQuaternionPack32(const kmQuaternion* pIn);
+kmQuaternion* kmQuaternionUnpack32(kmQuaternion* pOut, uint32_t packed);
+
+/**
+ * Decode count quaternions; pIn holds three words per quaternion.
+ */
+void kmQuaternionUnpack48Array(kmQuaternion* pOut, const uint16_t* pIn, size_t count);
+void kmQuaternionUnpack32Array(kmQuaternion* pOut, const uint32_t* pIn, size_t count);
+
+/**
+ * Stores each component as a 16 bit fraction of the extent of range.
+ * Points outside range are clamped to it. Inside it, each decoded
+ * component is within (max - min) / 131070 of the original.
+ */
+void kmVec3Quantize16(uint16_t pOut[3], const kmVec3* pIn, const kmAABB3* range);
+kmVec3* kmVec3Dequantize16(kmVec3* pOut, const uint16_t pIn[3], const kmAABB3* range);
+
+/**
+ * Decode count points; pIn holds three words per point.
+ */
+void kmVec3Dequantize16Array(kmVec3* pOut, const uint16_t* pIn, const kmAABB3* range, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_QUANTIZE_H_INCLUDED */
@@ -30,6 +30,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 #include <kazmath/utility.h>
 
 struct kmMat4;
@@ -43,6 +45,17 @@ typedef struct kmQuaternion {
 	kmScalar w;
 } kmQuaternion;
 
+/**
+ * A structure-of-arrays view over a set of quaternions, each pointer
+ * addresses one component of every quaternion.
+ */
+typedef struct kmQuaternionSoA {
+	kmScalar* x;
+	kmScalar* y;
+	kmScalar* z;
+	kmScalar* w;
+} kmQuaternionSoA;
+
 int kmQuaternionAreEqual(const kmQuaternion* p1, const kmQuaternion* p2);
 kmQuaternion* kmQuaternionFill(kmQuaternion* pOut, kmScalar x, kmScalar y,
                                kmScalar z, kmScalar w);
@@ -50,7 +63,10 @@ kmQuaternion* kmQuaternionFill(kmQuaternion* pOut, kmScalar x, kmScalar y,
 /** Returns the dot product of the 2 quaternions */
 kmScalar kmQuaternionDot(const kmQuaternion* q1, const kmQuaternion* q2);
 
-/** Returns the exponential of the quaternion (not implemented) */
+/**
+ * Returns the exponential of the quaternion. For a pure quaternion
+ * (0, theta * v) with |v| = 1 this is the rotation (cos(theta), sin(theta) * v).
+ */
 kmQuaternion* kmQuaternionExp(kmQuaternion* pOut, const kmQuaternion* pIn);
 
 /** Makes the passed quaternion an identity quaternion */
@@ -68,7 +84,10 @@ kmScalar kmQuaternionLength(const kmQuaternion* pIn);
 /** Returns the length of the quaternion squared (prevents a sqrt) */
 kmScalar kmQuaternionLengthSq(const kmQuaternion* pIn);
 
-/** Returns the natural logarithm */
+/**
+ * Returns the natural logarithm, the inverse of kmQuaternionExp. For a
+ * unit quaternion the result is pure: (0, theta * v).
+ */
 kmQuaternion* kmQuaternionLn(kmQuaternion* pOut, const kmQuaternion* pIn);
 
 /** Multiplies 2 quaternions together */
@@ -97,6 +116,80 @@ kmQuaternion* kmQuaternionRotationPitchYawRoll(kmQuaternion* pOut,
 kmQuaternion* kmQuaternionSlerp(kmQuaternion* pOut, const kmQuaternion* q1,
                                 const kmQuaternion* q2, kmScalar t);
 
+/**
+ * Slerps count pairs of unit quaternions, q1[i] to q2[i], into pOut.
+ * Each pair takes t[i], or uniformT if t is NULL. Unlike
+ * kmQuaternionSlerp the shorter arc is always taken, flipping q2[i]
+ * when the pair is more than 180 degrees apart. The arrays of pOut may
+ * alias those of q1 or q2.
+ */
+void kmQuaternionSlerpArray(const kmQuaternionSoA* pOut, const kmQuaternionSoA* q1,
+                            const kmQuaternionSoA* q2, const kmScalar* t,
+                            kmScalar uniformT, size_t count);
+
+/**
+ * As kmQuaternionSlerpArray, but blends linearly and renormalizes,
+ * which is cheaper and close to slerp for small angles.
+ */
+void kmQuaternionNlerpArray(const kmQuaternionSoA* pOut, const kmQuaternionSoA* q1,
+                            const kmQuaternionSoA* q2, const kmScalar* t,
+                            kmScalar uniformT, size_t count);
+
+/**
+ * Approximates slerp between unit quaternions without acos, sin, cos,
+ * sqrt or division, using Eberly's polynomial expansion of
+ * sin(t * theta) / sin(theta) in cos(theta) ("A Fast and Accurate
+ * Algorithm for Computing SLERP"). The shorter arc is taken. For t in
+ * [0, 1] and any pair of unit quaternions the result is within 2e-5 rad
+ * of an exact slerp and its length within 4e-5 of 1, the worst case
+ * being rotations 180 degrees apart.
+ */
+kmQuaternion* kmQuaternionSlerpFast(kmQuaternion* pOut, const kmQuaternion* q1,
+                                    const kmQuaternion* q2, kmScalar t);
+
+/**
+ * kmQuaternionSlerpFast over streams, with t as for
+ * kmQuaternionSlerpArray.
+ */
+void kmQuaternionSlerpFastArray(const kmQuaternionSoA* pOut, const kmQuaternionSoA* q1,
+                                const kmQuaternionSoA* q2, const kmScalar* t,
+                                kmScalar uniformT, size_t count);
+
+/**
+ * Computes the inner control point for key q of a squad spline, from
+ * the keys before and after it. prev and next are flipped as needed to
+ * be on q's side; the ends of a spline can pass q itself as prev or
+ * next.
+ */
+kmQuaternion* kmQuaternionSquadTangent(kmQuaternion* pOut, const kmQuaternion* prev,
+                                       const kmQuaternion* q, const kmQuaternion* next);
+
+/**
+ * kmQuaternionSquadTangent for every key of a spline through count
+ * keys, keys[0] and keys[count - 1] using themselves as their missing
+ * neighbour. Consecutive keys should have a non-negative dot product.
+ * pOut may be keys.
+ */
+void kmQuaternionSquadTangentArray(kmQuaternion* pOut, const kmQuaternion* keys, size_t count);
+
+/**
+ * Spherical cubic interpolation from q1 to q2 with control points a
+ * (the tangent of q1) and b (the tangent of q2), as produced by
+ * kmQuaternionSquadTangent. Unlike slerp, the rotation rate is
+ * continuous across keys.
+ */
+kmQuaternion* kmQuaternionSquad(kmQuaternion* pOut, const kmQuaternion* q1,
+                                const kmQuaternion* q2, const kmQuaternion* a,
+                                const kmQuaternion* b, kmScalar t);
+
+/**
+ * kmQuaternionSquad over streams, with t as for kmQuaternionSlerpArray.
+ */
+void kmQuaternionSquadArray(const kmQuaternionSoA* pOut, const kmQuaternionSoA* q1,
+                            const kmQuaternionSoA* q2, const kmQuaternionSoA* a,
+                            const kmQuaternionSoA* b, const kmScalar* t,
+                            kmScalar uniformT, size_t count);
+
 /** Get the axis and angle of rotation from a quaternion */
 void kmQuaternionToAxisAngle(const kmQuaternion* pIn, struct kmVec3* pVector,
                              kmScalar* pAngle);
@@ -128,6 +221,16 @@ struct kmVec3* kmQuaternionMultiplyVec3(struct kmVec3* pOut,
                                         const kmQuaternion* q,
                                         const struct kmVec3* v);
 
+/**
+ * Rotates count vectors by q. Vectors are read from pIn and written to
+ * pOut at the given byte strides (0 means tightly packed kmVec3s), so
+ * both may point into interleaved vertex data; pOut may equal pIn when
+ * the strides match. Past a handful of vectors q is converted to a 3x3
+ * matrix once, which is cheaper per vector than kmQuaternionMultiplyVec3.
+ */
+void kmQuaternionMultiplyVec3Array(struct kmVec3* pOut, size_t outStride, const kmQuaternion* q,
+                                   const struct kmVec3* pIn, size_t inStride, size_t count);
+
 kmVec3* kmQuaternionGetUpVec3(kmVec3* pOut, const kmQuaternion* pIn);
 kmVec3* kmQuaternionGetRightVec3(kmVec3* pOut, const kmQuaternion* pIn);
 kmVec3* kmQuaternionGetForwardVec3RH(kmVec3* pOut, const kmQuaternion* pIn);
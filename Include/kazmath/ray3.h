@@ -26,8 +26,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef RAY3_H
 #define RAY3_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <kazmath/utility.h>
+#include <kazmath/vec2.h>
 #include <kazmath/vec3.h>
+#include <kazmath/mat4.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,8 +43,65 @@ typedef struct kmRay3 {
     kmVec3 dir;
 } kmRay3;
 
+/**
+ * A ray prepared for repeated slab tests: the direction is normalized
+ * and inverted once, and the sign of each component selects which
+ * face of a box is entered first. Hits are only reported between tmin
+ * and tmax, measured along the normalized direction.
+ */
+typedef struct kmRay3Precomputed {
+    kmVec3 origin;
+    kmVec3 dir;
+    kmVec3 invDir;
+    kmUchar sign[3];
+    kmScalar tmin;
+    kmScalar tmax;
+} kmRay3Precomputed;
+
+/**
+ * A structure-of-arrays stream of triangles prepared for
+ * kmRay3IntersectTriangleArray, storing the first vertex and the two
+ * edges leaving it. Each pointer addresses one component of every
+ * triangle.
+ */
+typedef struct kmTriangle3SoA {
+    kmScalar* v0x;
+    kmScalar* v0y;
+    kmScalar* v0z;
+    kmScalar* e1x;
+    kmScalar* e1y;
+    kmScalar* e1z;
+    kmScalar* e2x;
+    kmScalar* e2y;
+    kmScalar* e2z;
+} kmTriangle3SoA;
+
+#define KM_RAY3_CULL_BACK_FACES (kmEnum)0
+#define KM_RAY3_DOUBLE_SIDED (kmEnum)1
+
+#define KM_SCREEN_LAYOUT_DEFAULT (kmEnum)0
+#define KM_SCREEN_LAYOUT_TILT (kmEnum)1
+
+/**
+ * Cached state for turning screen points into pick rays. Fill it with
+ * kmRay3PickerFill whenever the camera or viewport changes; the
+ * inverse view-projection is then reused for every sample.
+ *
+ * KM_SCREEN_LAYOUT_TILT is for projections from kmMat4PerspTilt and
+ * kmMat4OrthoTilt, whose clip space is rotated a quarter turn against
+ * the screen and whose depth range is [-1, 0].
+ */
+typedef struct kmRay3Picker {
+    kmMat4 inverseViewProjection;
+    kmScalar width;
+    kmScalar height;
+    kmEnum layout;
+} kmRay3Picker;
+
 struct kmPlane;
 struct kmAABB3;
+struct kmSphere;
+struct kmOBB3;
 
 kmRay3* kmRay3Fill(kmRay3* ray, kmScalar px, kmScalar py, kmScalar pz, kmScalar vx, kmScalar vy, kmScalar vz);
 kmRay3* kmRay3FromPointAndDirection(kmRay3* ray, const kmVec3* point, const kmVec3* direction);
@@ -47,6 +109,101 @@ kmBool kmRay3IntersectPlane(kmVec3* pOut, const kmRay3* ray, const struct kmPlan
 kmBool kmRay3IntersectTriangle(const kmRay3* ray, const kmVec3* v0, const kmVec3* v1, const kmVec3* v2, kmVec3* intersection, kmVec3* normal, kmScalar* distance);
 kmBool kmRay3IntersectAABB3(const kmRay3* ray, const struct kmAABB3* aabb, kmVec3* intersection, kmScalar* distance);
 
+/**
+ * Prepares ray for kmRay3PrecomputedIntersectAABB3 with tmin = 0 and
+ * tmax = FLT_MAX. Zero direction components give an infinite
+ * inverse, which the slab test handles.
+ */
+kmRay3Precomputed* kmRay3PrecomputedFromRay3(kmRay3Precomputed* pOut, const kmRay3* ray);
+
+/**
+ * Branchless slab test. Unlike kmRay3IntersectAABB3 a ray starting
+ * inside the box hits at tmin rather than at a negative distance.
+ * intersection and distance may be NULL.
+ */
+kmBool kmRay3PrecomputedIntersectAABB3(const kmRay3Precomputed* ray, const struct kmAABB3* aabb, kmVec3* intersection, kmScalar* distance);
+
+/**
+ * Writes count triangles into the stream pOut. Triangle i uses the
+ * vertices indices[i * 3 + 0..2], or vertices[i * 3 + 0..2] if indices
+ * is NULL.
+ */
+void kmTriangle3SoAFill(const kmTriangle3SoA* pOut, const kmVec3* vertices, const uint32_t* indices, size_t count);
+
+/**
+ * Finds the closest of count triangles hit by ray, using the same
+ * rules as kmRay3IntersectTriangle. With KM_RAY3_DOUBLE_SIDED back
+ * faces are hit too and the normal is flipped to face the ray.
+ * Every output may be NULL and is only computed for the winning
+ * triangle; u and v receive its barycentric coordinates.
+ */
+kmBool kmRay3IntersectTriangleArray(const kmRay3* ray, const kmTriangle3SoA* triangles, size_t count, kmEnum mode,
+                                    size_t* triangle, kmVec3* intersection, kmVec3* normal, kmScalar* distance,
+                                    kmScalar* u, kmScalar* v);
+
+/**
+ * Prepares picker for a width x height screen, measured in the
+ * orientation the user sees. Returns NULL if projection * view cannot
+ * be inverted.
+ */
+kmRay3Picker* kmRay3PickerFill(kmRay3Picker* pOut, const kmMat4* view, const kmMat4* projection,
+                               kmScalar width, kmScalar height, kmEnum layout);
+
+/**
+ * Builds the ray through the screen point (x, y), with the origin in
+ * the top left corner and y growing downwards. The ray starts on the
+ * near plane and ends on the far plane. Returns pOut.
+ */
+kmRay3* kmRay3FromScreenPoint(kmRay3* pOut, const kmRay3Picker* picker, kmScalar x, kmScalar y);
+
+/**
+ * Builds count rays, one for each screen point in points.
+ */
+void kmRay3FromScreenPoints(kmRay3* pOut, const kmRay3Picker* picker, const kmVec2* points, size_t count);
+
+/**
+ * Any-hit tests for shadow and visibility rays. Each returns KM_TRUE as
+ * soon as something is hit closer than maxDistance, measured along the
+ * normalized ray direction, without computing the hit point or normal.
+ * The length of ray->dir is ignored.
+ */
+kmBool kmRay3OccludedPlane(const kmRay3* ray, const struct kmPlane* plane, kmScalar maxDistance);
+kmBool kmRay3OccludedAABB3(const kmRay3* ray, const struct kmAABB3* aabb, kmScalar maxDistance);
+kmBool kmRay3OccludedTriangle(const kmRay3* ray, const kmVec3* v0, const kmVec3* v1, const kmVec3* v2,
+                              kmEnum mode, kmScalar maxDistance);
+kmBool kmRay3OccludedTriangleArray(const kmRay3* ray, const kmTriangle3SoA* triangles, size_t count,
+                                   kmEnum mode, kmScalar maxDistance);
+
+/**
+ * Tests the segments from origin to each of count targets against the
+ * triangles, writing KM_TRUE to results[i] if target i is hidden.
+ * Returns the number of hidden targets.
+ */
+size_t kmRay3OccludedTargets(const kmVec3* origin, const kmVec3* targets, size_t count,
+                             const kmTriangle3SoA* triangles, size_t triangleCount, kmEnum mode,
+                             kmBool* results);
+
+/**
+ * Intersects the ray with a sphere. On a hit the entry point and its
+ * distance along the (normalized) ray direction are written to
+ * intersection and distance if they are not NULL. A ray starting
+ * inside the sphere hits at distance 0.
+ */
+kmBool kmRay3IntersectSphere(const kmRay3* ray, const struct kmSphere* sphere, kmVec3* intersection, kmScalar* distance);
+
+/**
+ * Intersects the ray with an oriented box by running the slab test in
+ * the box's local frame. Outputs are written as for
+ * kmRay3IntersectSphere.
+ */
+kmBool kmRay3IntersectOBB3(const kmRay3* ray, const struct kmOBB3* obb, kmVec3* intersection, kmScalar* distance);
+
+/**
+ * Tests the ray against count spheres, writing one result per sphere.
+ * Returns the number of spheres hit.
+ */
+size_t kmRay3IntersectSphereArray(const kmRay3* ray, const struct kmSphere* spheres, size_t count, kmBool* results);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,98 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_RAY3_PACKET_H_INCLUDED
+#define KAZMATH_RAY3_PACKET_H_INCLUDED
+
+#include <stddef.h>
+
+#include <kazmath/utility.h>
+#include <kazmath/vec3.h>
+#include <kazmath/ray3.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct kmAABB3;
+
+/**
+ * Four rays stored one component per array so every test runs the
+ * same instructions across all lanes. Directions are normalized and
+ * distances are measured along them, as in kmRay3IntersectTriangle.
+ * Box hits are reported within [0, tmax]; triangle hits are limited
+ * to the length of the original ray direction.
+ */
+typedef struct kmRay3Packet4 {
+    kmScalar ox[4], oy[4], oz[4];
+    kmScalar dx[4], dy[4], dz[4];
+    kmScalar invDx[4], invDy[4], invDz[4];
+    kmScalar lengthSq[4];
+    kmScalar tmax[4];
+} kmRay3Packet4;
+
+/**
+ * The eight lane version of kmRay3Packet4.
+ */
+typedef struct kmRay3Packet8 {
+    kmScalar ox[8], oy[8], oz[8];
+    kmScalar dx[8], dy[8], dz[8];
+    kmScalar invDx[8], invDy[8], invDz[8];
+    kmScalar lengthSq[8];
+    kmScalar tmax[8];
+} kmRay3Packet8;
+
+/**
+ * Fills the packet from count rays (at most 4). Unused lanes never
+ * report a hit.
+ */
+kmRay3Packet4* kmRay3Packet4FromRays(kmRay3Packet4* pOut, const kmRay3* rays, size_t count);
+
+/**
+ * Slab tests every lane against aabb. Returns a mask with bit i set if
+ * lane i hits; distances (may be NULL) receives the entry distance of
+ * each lane and is only meaningful for lanes in the mask.
+ */
+unsigned kmRay3Packet4IntersectAABB3(const kmRay3Packet4* packet, const struct kmAABB3* aabb, kmScalar* distances);
+
+/**
+ * Moller-Trumbore test of every lane against the triangle v0, v1, v2,
+ * culling back faces exactly like kmRay3IntersectTriangle. Returns the
+ * hit mask; distances, u and v (each may be NULL) receive the distance
+ * and barycentric coordinates of each lane.
+ */
+unsigned kmRay3Packet4IntersectTriangle(const kmRay3Packet4* packet, const kmVec3* v0, const kmVec3* v1, const kmVec3* v2,
+                                        kmScalar* distances, kmScalar* u, kmScalar* v);
+
+kmRay3Packet8* kmRay3Packet8FromRays(kmRay3Packet8* pOut, const kmRay3* rays, size_t count);
+unsigned kmRay3Packet8IntersectAABB3(const kmRay3Packet8* packet, const struct kmAABB3* aabb, kmScalar* distances);
+unsigned kmRay3Packet8IntersectTriangle(const kmRay3Packet8* packet, const kmVec3* v0, const kmVec3* v1, const kmVec3* v2,
+                                        kmScalar* distances, kmScalar* u, kmScalar* v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_RAY3_PACKET_H_INCLUDED */
@@ -0,0 +1,124 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_SKIN_H_INCLUDED
+#define KAZMATH_SKIN_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kazmath/utility.h>
+#include <kazmath/dualquaternion.h>
+
+struct kmMat4;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KM_SKIN_MAX_INFLUENCES 4
+
+#define KM_SKIN_INDEX_U8 (kmEnum)0
+#define KM_SKIN_INDEX_U16 (kmEnum)1
+
+#define KM_SKIN_WEIGHT_U8 (kmEnum)0
+#define KM_SKIN_WEIGHT_FLOAT (kmEnum)1
+
+/**
+ * The bind pose vertices to be skinned. Every attribute is read at
+ * stride byte steps, so they can all point into one interleaved vertex
+ * buffer; a stride of 0 means the attribute is tightly packed on its
+ * own. Positions and normals are three kmScalars; normals may be
+ * NULL. Each vertex has influences (1, 2 or 4) bone indices of
+ * indexType and weights of weightType. U8 weights are normalized, 255
+ * being 1. The weights of a vertex should add up to one.
+ */
+typedef struct kmSkinVertices {
+    const void* positions;
+    size_t positionStride;
+    const void* normals;
+    size_t normalStride;
+    const void* indices;
+    size_t indexStride;
+    kmEnum indexType;
+    const void* weights;
+    size_t weightStride;
+    kmEnum weightType;
+    unsigned influences;
+} kmSkinVertices;
+
+/**
+ * An affine bone transform in 12 floats: the x, y and z axes followed
+ * by the translation, like the first three rows of a kmMat4's columns.
+ */
+typedef struct kmSkinMat3x4 {
+    kmScalar mat[12];
+} kmSkinMat3x4;
+
+/**
+ * Drops the last row of count matrices for a smaller palette.
+ */
+void kmSkinMat3x4FromMat4(kmSkinMat3x4* pOut, const struct kmMat4* pIn, size_t count);
+
+/**
+ * Linear blend skinning. Each vertex is transformed by the weighted sum
+ * of its bones' palette matrices. Writes count positions (and normals,
+ * if both vertices->normals and normals are not NULL) with the given
+ * byte strides, 0 meaning tightly packed. Normals go through the blended upper 3x3 and are not
+ * renormalized. The loop is specialized per influence count and index
+ * and weight type, so nothing is branched on per vertex.
+ */
+void kmSkinLinearBlend(void* positions, size_t positionStride,
+                       void* normals, size_t normalStride,
+                       const kmSkinVertices* vertices,
+                       const struct kmMat4* palette, size_t count);
+
+/**
+ * kmSkinLinearBlend with a kmSkinMat3x4 palette, which is a quarter
+ * smaller to read.
+ */
+void kmSkinLinearBlend3x4(void* positions, size_t positionStride,
+                          void* normals, size_t normalStride,
+                          const kmSkinVertices* vertices,
+                          const kmSkinMat3x4* palette, size_t count);
+
+/**
+ * Dual quaternion skinning. Blends the palette entries of each vertex's
+ * bones, normalizes the result and transforms the position and normal.
+ * Unlike linear blend skinning this keeps the volume around twisting
+ * joints. A vertex whose blend cancels out, such as one with all zero
+ * weights, takes the first bone's transform. Outputs are written as by
+ * kmSkinLinearBlend.
+ */
+void kmSkinDualQuaternion(void* positions, size_t positionStride,
+                          void* normals, size_t normalStride,
+                          const kmSkinVertices* vertices,
+                          const kmDualQuaternion* palette, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_SKIN_H_INCLUDED */
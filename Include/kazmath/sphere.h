@@ -0,0 +1,136 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_SPHERE_H_INCLUDED
+#define KAZMATH_SPHERE_H_INCLUDED
+
+#include <stddef.h>
+
+#include <kazmath/vec3.h>
+#include <kazmath/plane.h>
+#include <kazmath/utility.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct kmAABB3;
+
+/**
+ * A structure that represents a bounding sphere
+ */
+typedef struct kmSphere {
+    kmVec3 centre;
+    kmScalar radius;
+} kmSphere;
+
+/**
+ * Sets pOut to the sphere at centre with the given radius. If centre
+ * is NULL then the origin is used. Returns pOut.
+ */
+kmSphere* kmSphereFill(kmSphere* pOut, const kmVec3* centre, kmScalar radius);
+
+/**
+ * Assigns pIn to pOut, returns pOut.
+ */
+kmSphere* kmSphereAssign(kmSphere* pOut, const kmSphere* pIn);
+
+/**
+ * Fits a sphere around count points using Ritter's method. The
+ * initial sphere spans the most separated pair of axis-extreme points
+ * and is then grown to take in any point left outside. The result is
+ * usually within 5-20% of the optimal radius. Points are read stride
+ * bytes apart (0 means tightly packed kmVec3s). Returns pOut.
+ */
+kmSphere* kmSphereFromPoints(kmSphere* pOut, const kmVec3* points,
+                             size_t stride, size_t count);
+
+/**
+ * Tightens a sphere which already contains the points by repeatedly
+ * shrinking it slightly and re-growing it over the points, visiting
+ * them in a different order each pass. The smallest sphere found is
+ * kept, so the result is never larger than pIn. Returns pOut.
+ */
+kmSphere* kmSphereRefine(kmSphere* pOut, const kmSphere* pIn,
+                         const kmVec3* points, size_t stride,
+                         size_t count, kmUchar iterations);
+
+/**
+ * Sets pOut to the sphere passing through the corners of aabb.
+ * Returns pOut.
+ */
+kmSphere* kmSphereFromAABB3(kmSphere* pOut, const struct kmAABB3* aabb);
+
+/**
+ * Sets pOut to the smallest sphere enclosing both s1 and s2.
+ * Returns pOut.
+ */
+kmSphere* kmSphereMerge(kmSphere* pOut, const kmSphere* s1, const kmSphere* s2);
+
+/**
+ * Grows pIn just enough to contain point, result is stored in pOut.
+ * Returns pOut.
+ */
+kmSphere* kmSphereExpandToContain(kmSphere* pOut, const kmSphere* pIn,
+                                  const kmVec3* point);
+
+kmBool kmSphereContainsPoint(const kmSphere* sphere, const kmVec3* point);
+
+/**
+ * Returns KM_CONTAINS_ALL if to_check is completely inside container,
+ * KM_CONTAINS_PARTIAL if they overlap and KM_CONTAINS_NONE otherwise.
+ */
+kmEnum kmSphereContainsSphere(const kmSphere* container, const kmSphere* to_check);
+
+kmBool kmSphereIntersectsSphere(const kmSphere* s1, const kmSphere* s2);
+kmBool kmSphereIntersectsAABB3(const kmSphere* sphere, const struct kmAABB3* aabb);
+
+/**
+ * Returns POINT_INFRONT_OF_PLANE or POINT_BEHIND_PLANE if the sphere
+ * is entirely on one side of the plane, and POINT_ON_PLANE if the plane
+ * cuts through it. The plane is assumed to be normalized.
+ */
+KM_POINT_CLASSIFICATION kmSphereClassifyPlane(const kmSphere* sphere,
+                                              const kmPlane* plane);
+
+/**
+ * Batch forms of the tests above. Each tests count spheres against a
+ * single primitive, writes one result per sphere to results and
+ * returns the number of spheres which were hit (not behind the plane
+ * for kmSphereClassifyPlaneArray).
+ */
+size_t kmSphereIntersectsSphereArray(const kmSphere* spheres, size_t count,
+                                     const kmSphere* other, kmBool* results);
+size_t kmSphereIntersectsAABB3Array(const kmSphere* spheres, size_t count,
+                                    const struct kmAABB3* aabb, kmBool* results);
+size_t kmSphereClassifyPlaneArray(const kmSphere* spheres, size_t count,
+                                  const kmPlane* plane,
+                                  KM_POINT_CLASSIFICATION* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
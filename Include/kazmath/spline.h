@@ -0,0 +1,90 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_SPLINE_H_INCLUDED
+#define KAZMATH_SPLINE_H_INCLUDED
+
+#include <stddef.h>
+
+#include <kazmath/utility.h>
+#include <kazmath/vec3.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * One segment of a cubic curve in power form,
+ * p(t) = ((a * t + b) * t + c) * t + d for t in [0, 1], so evaluating
+ * it costs three multiply-adds per component.
+ */
+typedef struct kmVec3Cubic {
+    kmVec3 a;
+    kmVec3 b;
+    kmVec3 c;
+    kmVec3 d;
+} kmVec3Cubic;
+
+/**
+ * The Hermite segment from p0 to p1 leaving p0 with tangent m0 and
+ * arriving at p1 with tangent m1. Tangents are per unit of t, so for
+ * keys dt seconds apart multiply velocities by dt.
+ */
+kmVec3Cubic* kmVec3CubicFromHermite(kmVec3Cubic* pOut, const kmVec3* p0, const kmVec3* m0,
+                                    const kmVec3* p1, const kmVec3* m1);
+
+/**
+ * The uniform Catmull-Rom segment from p1 to p2, which passes through
+ * every point and uses its neighbours for the tangents.
+ */
+kmVec3Cubic* kmVec3CubicFromCatmullRom(kmVec3Cubic* pOut, const kmVec3* p0, const kmVec3* p1,
+                                       const kmVec3* p2, const kmVec3* p3);
+
+/**
+ * Builds the count - 1 Catmull-Rom segments through count points, the
+ * first and last point standing in for their missing neighbours.
+ */
+void kmVec3CubicFromCatmullRomArray(kmVec3Cubic* pOut, const kmVec3* points, size_t count);
+
+kmVec3* kmVec3CubicEvaluate(kmVec3* pOut, const kmVec3Cubic* cubic, kmScalar t);
+
+/**
+ * Returns the derivative of the segment at t, e.g. the direction of
+ * travel of a camera path.
+ */
+kmVec3* kmVec3CubicDerivative(kmVec3* pOut, const kmVec3Cubic* cubic, kmScalar t);
+
+/**
+ * Evaluates count segments, cubics[i] at t[i], or at uniformT if t is
+ * NULL.
+ */
+void kmVec3CubicEvaluateArray(kmVec3* pOut, const kmVec3Cubic* cubics, const kmScalar* t,
+                              kmScalar uniformT, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_SPLINE_H_INCLUDED */
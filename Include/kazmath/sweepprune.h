@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_SWEEPPRUNE_H_INCLUDED
+#define KAZMATH_SWEEPPRUNE_H_INCLUDED
+
+#include <stdint.h>
+
+#include <kazmath/aabb2.h>
+#include <kazmath/aabb3.h>
+#include <kazmath/utility.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * One end of a box on a sorted axis. data holds the proxy index
+ * shifted left by one, with the low bit set for a max endpoint.
+ */
+typedef struct kmSAPEndpoint {
+    kmScalar value;
+    uint32_t data;
+} kmSAPEndpoint;
+
+/**
+ * An overlapping pair of proxies with a < b.
+ */
+typedef struct kmSAPPair {
+    uint32_t a;
+    uint32_t b;
+} kmSAPPair;
+
+/**
+ * A sort-and-sweep broadphase. The box endpoints are kept sorted on
+ * every axis; each frame the new bounds are written in and the axes are
+ * re-sorted with insertion sort, which is close to linear when little
+ * has moved. Overlaps can only start or stop where two endpoints swap,
+ * so only those pairs are tested, and the changes are reported through
+ * the added and removed arrays rather than as a full pair list.
+ *
+ * 2D boxes are stored with a zero z range and only two axes sorted.
+ */
+typedef struct kmSweepAndPrune {
+    kmAABB3* boxes;
+    uint32_t proxyCount;
+    int axisCount;
+    kmSAPEndpoint* endpoints[3];
+
+    uint64_t* pairKeys;     /* Open addressed set of the current pairs */
+    uint32_t pairCapacity;
+    uint32_t pairCount;
+    uint32_t pairTombstones;
+
+    kmSAPPair* added;       /* Pairs that started overlapping */
+    uint32_t addedCount;
+    uint32_t addedCapacity;
+    kmSAPPair* removed;     /* Pairs that stopped overlapping */
+    uint32_t removedCount;
+    uint32_t removedCapacity;
+} kmSweepAndPrune;
+
+void kmSweepAndPruneInitialize(kmSweepAndPrune* sap);
+void kmSweepAndPruneRelease(kmSweepAndPrune* sap);
+
+/**
+ * Replaces the proxies with count boxes, radix sorting the endpoints
+ * from scratch. Every overlapping pair is reported in added. Returns
+ * KM_FALSE if memory could not be allocated.
+ */
+kmBool kmSweepAndPruneBuild3(kmSweepAndPrune* sap, const kmAABB3* boxes, uint32_t count);
+kmBool kmSweepAndPruneBuild2(kmSweepAndPrune* sap, const kmAABB2* boxes, uint32_t count);
+
+/**
+ * Moves every proxy to its new box, boxes holding as many entries as
+ * the last build, and fills added and removed with the changes since
+ * the previous call. Returns KM_FALSE if memory could not be
+ * allocated.
+ */
+kmBool kmSweepAndPruneUpdate3(kmSweepAndPrune* sap, const kmAABB3* boxes);
+kmBool kmSweepAndPruneUpdate2(kmSweepAndPrune* sap, const kmAABB2* boxes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KAZMATH_SWEEPPRUNE_H_INCLUDED */
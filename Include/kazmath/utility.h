@@ -34,7 +34,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define kmPI 3.14159265358979323846f
 #define kmPIOver180  (kmPI / 180.0f)
-#define kmPIUnder180 (180.0 / kmPI)
+#define kmPIUnder180 (180.0f / kmPI)
 #define kmEpsilon FLT_EPSILON
 
 #define KM_CONTAINS_NONE (kmEnum)0
@@ -79,7 +79,7 @@ static inline kmScalar kmRadiansToRevolutions(kmScalar radians) { return radians
 
 static inline kmScalar kmMin(kmScalar lhs, kmScalar rhs) { return (lhs < rhs)? lhs : rhs; }
 static inline kmScalar kmMax(kmScalar lhs, kmScalar rhs) { return (lhs > rhs)? lhs : rhs; }
-static inline kmBool kmAlmostEqual(kmScalar lhs, kmScalar rhs) { return (fabs(lhs - rhs) <= kmEpsilon * fmax(1.0f, fmax(lhs, rhs))); }
+static inline kmBool kmAlmostEqual(kmScalar lhs, kmScalar rhs) { return (fabsf(lhs - rhs) <= kmEpsilon * fmaxf(1.0f, fmaxf(lhs, rhs))); }
 
 static inline kmScalar kmClamp(kmScalar x, kmScalar min, kmScalar max) { return x < min ? min : (x > max ? max : x); }
 static inline kmScalar kmLerp(kmScalar x, kmScalar y, kmScalar factor) { return x + factor * ( y - x ); }
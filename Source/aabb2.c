@@ -25,6 +25,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <kazmath/aabb2.h>
 
+#include "stride.h"
 
 kmAABB2* kmAABB2Initialize( kmAABB2* pBox, const kmVec2* centre, const kmScalar width, const kmScalar height, const kmScalar depth) {
     kmVec2 origin;
@@ -160,3 +161,44 @@ kmAABB2* kmAABB2ExpandToContain(kmAABB2* pOut, const kmAABB2* pIn, const kmAABB2
 
     return pOut;
 }
+
+kmAABB2* kmAABB2FromPoints(kmAABB2* pOut, const kmVec2* points, size_t stride, size_t count) {
+    const kmVec2* v;
+    size_t i;
+
+    kmScalar minX[4], minY[4];
+    kmScalar maxX[4], maxY[4];
+
+    if(!stride) stride = sizeof(kmVec2);
+
+    for(i = 0; i < 4; ++i) {
+        minX[i] = minY[i] = FLT_MAX;
+        maxX[i] = maxY[i] = -FLT_MAX;
+    }
+
+    for(i = 0; i + 4 <= count; i += 4) {
+        int j;
+        for(j = 0; j < 4; ++j) {
+            v = KM_STRIDED_AT(kmVec2, points, stride, i + j);
+            minX[j] = kmMin(minX[j], v->x);
+            minY[j] = kmMin(minY[j], v->y);
+            maxX[j] = kmMax(maxX[j], v->x);
+            maxY[j] = kmMax(maxY[j], v->y);
+        }
+    }
+
+    for(; i < count; ++i) {
+        v = KM_STRIDED_AT(kmVec2, points, stride, i);
+        minX[0] = kmMin(minX[0], v->x);
+        minY[0] = kmMin(minY[0], v->y);
+        maxX[0] = kmMax(maxX[0], v->x);
+        maxY[0] = kmMax(maxY[0], v->y);
+    }
+
+    pOut->min.x = kmMin(kmMin(minX[0], minX[1]), kmMin(minX[2], minX[3]));
+    pOut->min.y = kmMin(kmMin(minY[0], minY[1]), kmMin(minY[2], minY[3]));
+    pOut->max.x = kmMax(kmMax(maxX[0], maxX[1]), kmMax(maxX[2], maxX[3]));
+    pOut->max.y = kmMax(kmMax(maxY[0], maxY[1]), kmMax(maxY[2], maxY[3]));
+
+    return pOut;
+}
@@ -25,7 +25,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdlib.h>
 #include <kazmath/aabb3.h>
+#include <kazmath/mat4.h>
+#include <kazmath/plane.h>
 
+#include "stride.h"
 
 kmAABB3* kmAABB3Initialize(kmAABB3* pBox, const kmVec3* centre, const kmScalar width, const kmScalar height, const kmScalar depth) {
     kmVec3 origin;
@@ -78,25 +81,25 @@ kmBool kmAABB3IntersectsTriangle(kmAABB3* box, const kmVec3* p1, const kmVec3* p
 kmBool kmAABB3IntersectsAABB(const kmAABB3* box, const kmAABB3* other) {
     /* Probably should store center point and radius for things like this */
 
-    kmScalar acx = (box->min.x + box->max.x) * 0.5;
-    kmScalar acy = (box->min.y + box->max.y) * 0.5;
-    kmScalar acz = (box->min.z + box->max.z) * 0.5;
+    kmScalar acx = (box->min.x + box->max.x) * 0.5f;
+    kmScalar acy = (box->min.y + box->max.y) * 0.5f;
+    kmScalar acz = (box->min.z + box->max.z) * 0.5f;
 
-    kmScalar bcx = (other->min.x + other->max.x) * 0.5;
-    kmScalar bcy = (other->min.y + other->max.y) * 0.5;
-    kmScalar bcz = (other->min.z + other->max.z) * 0.5;
+    kmScalar bcx = (other->min.x + other->max.x) * 0.5f;
+    kmScalar bcy = (other->min.y + other->max.y) * 0.5f;
+    kmScalar bcz = (other->min.z + other->max.z) * 0.5f;
 
-    kmScalar arx = (box->max.x - box->min.x) * 0.5;
-    kmScalar ary = (box->max.y - box->min.y) * 0.5;
-    kmScalar arz = (box->max.z - box->min.z) * 0.5;
+    kmScalar arx = (box->max.x - box->min.x) * 0.5f;
+    kmScalar ary = (box->max.y - box->min.y) * 0.5f;
+    kmScalar arz = (box->max.z - box->min.z) * 0.5f;
 
-    kmScalar brx = (other->max.x - other->min.x) * 0.5;
-    kmScalar bry = (other->max.y - other->min.y) * 0.5;
-    kmScalar brz = (other->max.z - other->min.z) * 0.5;
+    kmScalar brx = (other->max.x - other->min.x) * 0.5f;
+    kmScalar bry = (other->max.y - other->min.y) * 0.5f;
+    kmScalar brz = (other->max.z - other->min.z) * 0.5f;
 
-    kmBool x = abs(acx - bcx) <= (arx + brx);
-    kmBool y = abs(acy - bcy) <= (ary + bry);
-    kmBool z = abs(acz - bcz) <= (arz + brz);
+    kmBool x = fabsf(acx - bcx) <= (arx + brx);
+    kmBool y = fabsf(acy - bcy) <= (ary + bry);
+    kmBool z = fabsf(acz - bcz) <= (arz + brz);
 
     return x && y && z;
 }
@@ -137,15 +140,15 @@ kmEnum kmAABB3ContainsAABB(const kmAABB3* container, const kmAABB3* to_check) {
 }
 
 kmScalar kmAABB3DiameterX(const kmAABB3* aabb) {
-    return fabs(aabb->max.x - aabb->min.x);
+    return fabsf(aabb->max.x - aabb->min.x);
 }
 
 kmScalar kmAABB3DiameterY(const kmAABB3* aabb) {
-    return fabs(aabb->max.y - aabb->min.y);
+    return fabsf(aabb->max.y - aabb->min.y);
 }
 
 kmScalar kmAABB3DiameterZ(const kmAABB3* aabb) {
-    return fabs(aabb->max.z - aabb->min.z);
+    return fabsf(aabb->max.z - aabb->min.z);
 }
 
 kmVec3* kmAABB3Centre(const kmAABB3* aabb, kmVec3* pOut) {
@@ -154,6 +157,13 @@ kmVec3* kmAABB3Centre(const kmAABB3* aabb, kmVec3* pOut) {
     return pOut;
 }
 
+kmScalar kmAABB3SurfaceArea(const kmAABB3* aabb) {
+    kmScalar dx = aabb->max.x - aabb->min.x;
+    kmScalar dy = aabb->max.y - aabb->min.y;
+    kmScalar dz = aabb->max.z - aabb->min.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
 kmAABB3* kmAABB3ExpandToContain(kmAABB3* pOut, const kmAABB3* pIn, const kmAABB3* other) {
     kmAABB3 result;
 
@@ -168,3 +178,153 @@ kmAABB3* kmAABB3ExpandToContain(kmAABB3* pOut, const kmAABB3* pIn, const kmAABB3
 
     return pOut;
 }
+
+kmAABB3* kmAABB3Transform(kmAABB3* pOut, const kmAABB3* pIn, const kmMat4* pM) {
+    const kmScalar* m = pM->mat;
+
+    kmScalar cx = (pIn->min.x + pIn->max.x) * 0.5f;
+    kmScalar cy = (pIn->min.y + pIn->max.y) * 0.5f;
+    kmScalar cz = (pIn->min.z + pIn->max.z) * 0.5f;
+
+    kmScalar ex = (pIn->max.x - pIn->min.x) * 0.5f;
+    kmScalar ey = (pIn->max.y - pIn->min.y) * 0.5f;
+    kmScalar ez = (pIn->max.z - pIn->min.z) * 0.5f;
+
+    /* New centre is M * c, new extent is |M| * e */
+    kmScalar ncx = m[0] * cx + m[4] * cy + m[8] * cz + m[12];
+    kmScalar ncy = m[1] * cx + m[5] * cy + m[9] * cz + m[13];
+    kmScalar ncz = m[2] * cx + m[6] * cy + m[10] * cz + m[14];
+
+    kmScalar nex = fabsf(m[0]) * ex + fabsf(m[4]) * ey + fabsf(m[8]) * ez;
+    kmScalar ney = fabsf(m[1]) * ex + fabsf(m[5]) * ey + fabsf(m[9]) * ez;
+    kmScalar nez = fabsf(m[2]) * ex + fabsf(m[6]) * ey + fabsf(m[10]) * ez;
+
+    pOut->min.x = ncx - nex;
+    pOut->min.y = ncy - ney;
+    pOut->min.z = ncz - nez;
+
+    pOut->max.x = ncx + nex;
+    pOut->max.y = ncy + ney;
+    pOut->max.z = ncz + nez;
+
+    return pOut;
+}
+
+kmAABB3* kmAABB3TransformArray(kmAABB3* pOut, const kmAABB3* pIn, const kmMat4* matrices, size_t count) {
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmAABB3Transform(&pOut[i], &pIn[i], &matrices[i]);
+    }
+
+    return pOut;
+}
+
+void kmAABB3TransformSoA(const kmAABB3SoA* pOut, const kmAABB3SoA* pIn, const kmMat4* matrices, size_t count) {
+    size_t i;
+
+    /* Kept branch free so the loop body maps directly onto vector lanes */
+    for(i = 0; i < count; ++i) {
+        const kmScalar* m = matrices[i].mat;
+
+        kmScalar cx = (pIn->minX[i] + pIn->maxX[i]) * 0.5f;
+        kmScalar cy = (pIn->minY[i] + pIn->maxY[i]) * 0.5f;
+        kmScalar cz = (pIn->minZ[i] + pIn->maxZ[i]) * 0.5f;
+
+        kmScalar ex = (pIn->maxX[i] - pIn->minX[i]) * 0.5f;
+        kmScalar ey = (pIn->maxY[i] - pIn->minY[i]) * 0.5f;
+        kmScalar ez = (pIn->maxZ[i] - pIn->minZ[i]) * 0.5f;
+
+        kmScalar ncx = m[0] * cx + m[4] * cy + m[8] * cz + m[12];
+        kmScalar ncy = m[1] * cx + m[5] * cy + m[9] * cz + m[13];
+        kmScalar ncz = m[2] * cx + m[6] * cy + m[10] * cz + m[14];
+
+        kmScalar nex = fabsf(m[0]) * ex + fabsf(m[4]) * ey + fabsf(m[8]) * ez;
+        kmScalar ney = fabsf(m[1]) * ex + fabsf(m[5]) * ey + fabsf(m[9]) * ez;
+        kmScalar nez = fabsf(m[2]) * ex + fabsf(m[6]) * ey + fabsf(m[10]) * ez;
+
+        pOut->minX[i] = ncx - nex;
+        pOut->minY[i] = ncy - ney;
+        pOut->minZ[i] = ncz - nez;
+
+        pOut->maxX[i] = ncx + nex;
+        pOut->maxY[i] = ncy + ney;
+        pOut->maxZ[i] = ncz + nez;
+    }
+}
+
+kmEnum kmAABB3IntersectsFrustum(const kmAABB3* aabb, const kmPlane* planes) {
+    kmEnum result = KM_CONTAINS_ALL;
+    int i;
+
+    for(i = 0; i < 6; ++i) {
+        const kmPlane* p = &planes[i];
+
+        /* The corners furthest along (p) and against (n) the normal */
+        kmScalar px = (p->a >= 0) ? aabb->max.x : aabb->min.x;
+        kmScalar py = (p->b >= 0) ? aabb->max.y : aabb->min.y;
+        kmScalar pz = (p->c >= 0) ? aabb->max.z : aabb->min.z;
+        kmScalar nx = (p->a >= 0) ? aabb->min.x : aabb->max.x;
+        kmScalar ny = (p->b >= 0) ? aabb->min.y : aabb->max.y;
+        kmScalar nz = (p->c >= 0) ? aabb->min.z : aabb->max.z;
+
+        if(p->a * px + p->b * py + p->c * pz + p->d < 0) {
+            return KM_CONTAINS_NONE;
+        }
+
+        if(p->a * nx + p->b * ny + p->c * nz + p->d < 0) {
+            result = KM_CONTAINS_PARTIAL;
+        }
+    }
+
+    return result;
+}
+
+kmAABB3* kmAABB3FromPoints(kmAABB3* pOut, const kmVec3* points, size_t stride, size_t count) {
+    const kmVec3* v;
+    size_t i;
+
+    /* Four independent accumulators per component so consecutive
+     * compares do not depend on each other */
+    kmScalar minX[4], minY[4], minZ[4];
+    kmScalar maxX[4], maxY[4], maxZ[4];
+
+    if(!stride) stride = sizeof(kmVec3);
+
+    for(i = 0; i < 4; ++i) {
+        minX[i] = minY[i] = minZ[i] = FLT_MAX;
+        maxX[i] = maxY[i] = maxZ[i] = -FLT_MAX;
+    }
+
+    for(i = 0; i + 4 <= count; i += 4) {
+        int j;
+        for(j = 0; j < 4; ++j) {
+            v = KM_STRIDED_AT(kmVec3, points, stride, i + j);
+            minX[j] = kmMin(minX[j], v->x);
+            minY[j] = kmMin(minY[j], v->y);
+            minZ[j] = kmMin(minZ[j], v->z);
+            maxX[j] = kmMax(maxX[j], v->x);
+            maxY[j] = kmMax(maxY[j], v->y);
+            maxZ[j] = kmMax(maxZ[j], v->z);
+        }
+    }
+
+    for(; i < count; ++i) {
+        v = KM_STRIDED_AT(kmVec3, points, stride, i);
+        minX[0] = kmMin(minX[0], v->x);
+        minY[0] = kmMin(minY[0], v->y);
+        minZ[0] = kmMin(minZ[0], v->z);
+        maxX[0] = kmMax(maxX[0], v->x);
+        maxY[0] = kmMax(maxY[0], v->y);
+        maxZ[0] = kmMax(maxZ[0], v->z);
+    }
+
+    pOut->min.x = kmMin(kmMin(minX[0], minX[1]), kmMin(minX[2], minX[3]));
+    pOut->min.y = kmMin(kmMin(minY[0], minY[1]), kmMin(minY[2], minY[3]));
+    pOut->min.z = kmMin(kmMin(minZ[0], minZ[1]), kmMin(minZ[2], minZ[3]));
+    pOut->max.x = kmMax(kmMax(maxX[0], maxX[1]), kmMax(maxX[2], maxX[3]));
+    pOut->max.y = kmMax(kmMax(maxY[0], maxY[1]), kmMax(maxY[2], maxY[3]));
+    pOut->max.z = kmMax(kmMax(maxZ[0], maxZ[1]), kmMax(maxZ[2], maxZ[3]));
+
+    return pOut;
+}
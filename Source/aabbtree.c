@@ -0,0 +1,548 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kazmath/aabbtree.h>
+#include <kazmath/ray3.h>
+#include <kazmath/plane.h>
+
+#define INITIAL_SIZE 16
+#define STACK_SIZE 256
+
+static kmBool kmAABBTreeIsLeaf(const kmAABBTreeNode* node) {
+    return node->child1 == KM_AABB_TREE_NULL_NODE;
+}
+
+static kmBool kmAABB3Encloses(const kmAABB3* outer, const kmAABB3* inner) {
+    return outer->min.x <= inner->min.x && outer->min.y <= inner->min.y &&
+           outer->min.z <= inner->min.z && outer->max.x >= inner->max.x &&
+           outer->max.y >= inner->max.y && outer->max.z >= inner->max.z;
+}
+
+/* Doubles the node pool, leaving the tree untouched if that fails */
+static kmBool kmAABBTreeGrow(kmAABBTree* tree) {
+    int i;
+    int capacity = tree->nodeCapacity ? tree->nodeCapacity * 2 : INITIAL_SIZE;
+    kmAABBTreeNode* nodes = (kmAABBTreeNode*) malloc(capacity * sizeof(kmAABBTreeNode));
+
+    if(!nodes) {
+        return KM_FALSE;
+    }
+
+    if(tree->nodes) {
+        memcpy(nodes, tree->nodes, tree->nodeCapacity * sizeof(kmAABBTreeNode));
+        free(tree->nodes);
+    }
+
+    /* Chain the new nodes onto the front of the free list */
+    for(i = tree->nodeCapacity; i < capacity - 1; ++i) {
+        nodes[i].parent = i + 1;
+        nodes[i].height = -1;
+    }
+    nodes[capacity - 1].parent = tree->freeList;
+    nodes[capacity - 1].height = -1;
+
+    tree->freeList = tree->nodeCapacity;
+    tree->nodes = nodes;
+    tree->nodeCapacity = capacity;
+
+    return KM_TRUE;
+}
+
+static int kmAABBTreeAllocateNode(kmAABBTree* tree) {
+    int id;
+
+    if(tree->freeList == KM_AABB_TREE_NULL_NODE && !kmAABBTreeGrow(tree)) {
+        return KM_AABB_TREE_NULL_NODE;
+    }
+
+    id = tree->freeList;
+    tree->freeList = tree->nodes[id].parent;
+    tree->nodes[id].parent = KM_AABB_TREE_NULL_NODE;
+    tree->nodes[id].child1 = KM_AABB_TREE_NULL_NODE;
+    tree->nodes[id].child2 = KM_AABB_TREE_NULL_NODE;
+    tree->nodes[id].height = 0;
+    tree->nodes[id].userData = NULL;
+    ++tree->nodeCount;
+
+    return id;
+}
+
+static void kmAABBTreeFreeNode(kmAABBTree* tree, int id) {
+    assert(0 <= id && id < tree->nodeCapacity);
+    assert(tree->nodeCount > 0);
+
+    tree->nodes[id].parent = tree->freeList;
+    tree->nodes[id].height = -1;
+    tree->freeList = id;
+    --tree->nodeCount;
+}
+
+/*
+ * Rotates the taller child of iA above it if the children's heights
+ * differ by more than one. Returns the index of the new subtree root.
+ */
+static int kmAABBTreeBalance(kmAABBTree* tree, int iA) {
+    kmAABBTreeNode* nodes = tree->nodes;
+    kmAABBTreeNode* A = &nodes[iA];
+    kmAABBTreeNode *B, *C;
+    int iB, iC, balance;
+
+    if(kmAABBTreeIsLeaf(A) || A->height < 2) {
+        return iA;
+    }
+
+    iB = A->child1;
+    iC = A->child2;
+    B = &nodes[iB];
+    C = &nodes[iC];
+
+    balance = C->height - B->height;
+
+    if(balance > 1) {
+        /* Rotate C up */
+        int iF = C->child1;
+        int iG = C->child2;
+        kmAABBTreeNode* F = &nodes[iF];
+        kmAABBTreeNode* G = &nodes[iG];
+
+        C->child1 = iA;
+        C->parent = A->parent;
+        A->parent = iC;
+
+        if(C->parent != KM_AABB_TREE_NULL_NODE) {
+            if(nodes[C->parent].child1 == iA) {
+                nodes[C->parent].child1 = iC;
+            } else {
+                assert(nodes[C->parent].child2 == iA);
+                nodes[C->parent].child2 = iC;
+            }
+        } else {
+            tree->root = iC;
+        }
+
+        if(F->height > G->height) {
+            C->child2 = iF;
+            A->child2 = iG;
+            G->parent = iA;
+            kmAABB3ExpandToContain(&A->aabb, &B->aabb, &G->aabb);
+            kmAABB3ExpandToContain(&C->aabb, &A->aabb, &F->aabb);
+            A->height = 1 + (B->height > G->height ? B->height : G->height);
+            C->height = 1 + (A->height > F->height ? A->height : F->height);
+        } else {
+            C->child2 = iG;
+            A->child2 = iF;
+            F->parent = iA;
+            kmAABB3ExpandToContain(&A->aabb, &B->aabb, &F->aabb);
+            kmAABB3ExpandToContain(&C->aabb, &A->aabb, &G->aabb);
+            A->height = 1 + (B->height > F->height ? B->height : F->height);
+            C->height = 1 + (A->height > G->height ? A->height : G->height);
+        }
+
+        return iC;
+    }
+
+    if(balance < -1) {
+        /* Rotate B up */
+        int iD = B->child1;
+        int iE = B->child2;
+        kmAABBTreeNode* D = &nodes[iD];
+        kmAABBTreeNode* E = &nodes[iE];
+
+        B->child1 = iA;
+        B->parent = A->parent;
+        A->parent = iB;
+
+        if(B->parent != KM_AABB_TREE_NULL_NODE) {
+            if(nodes[B->parent].child1 == iA) {
+                nodes[B->parent].child1 = iB;
+            } else {
+                assert(nodes[B->parent].child2 == iA);
+                nodes[B->parent].child2 = iB;
+            }
+        } else {
+            tree->root = iB;
+        }
+
+        if(D->height > E->height) {
+            B->child2 = iD;
+            A->child1 = iE;
+            E->parent = iA;
+            kmAABB3ExpandToContain(&A->aabb, &C->aabb, &E->aabb);
+            kmAABB3ExpandToContain(&B->aabb, &A->aabb, &D->aabb);
+            A->height = 1 + (C->height > E->height ? C->height : E->height);
+            B->height = 1 + (A->height > D->height ? A->height : D->height);
+        } else {
+            B->child2 = iE;
+            A->child1 = iD;
+            D->parent = iA;
+            kmAABB3ExpandToContain(&A->aabb, &C->aabb, &D->aabb);
+            kmAABB3ExpandToContain(&B->aabb, &A->aabb, &E->aabb);
+            A->height = 1 + (C->height > D->height ? C->height : D->height);
+            B->height = 1 + (A->height > E->height ? A->height : E->height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+/* Walks from index to the root refitting boxes and rebalancing */
+static void kmAABBTreeRefitAncestors(kmAABBTree* tree, int index) {
+    while(index != KM_AABB_TREE_NULL_NODE) {
+        kmAABBTreeNode* node;
+        int h1, h2;
+
+        index = kmAABBTreeBalance(tree, index);
+        node = &tree->nodes[index];
+
+        h1 = tree->nodes[node->child1].height;
+        h2 = tree->nodes[node->child2].height;
+        node->height = 1 + (h1 > h2 ? h1 : h2);
+        kmAABB3ExpandToContain(&node->aabb, &tree->nodes[node->child1].aabb, &tree->nodes[node->child2].aabb);
+
+        index = node->parent;
+    }
+}
+
+static void kmAABBTreeInsertLeaf(kmAABBTree* tree, int leaf) {
+    kmAABBTreeNode* nodes;
+    kmAABB3 leafAABB, combined;
+    int index, sibling, oldParent, newParent;
+
+    if(tree->root == KM_AABB_TREE_NULL_NODE) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = KM_AABB_TREE_NULL_NODE;
+        return;
+    }
+
+    leafAABB = tree->nodes[leaf].aabb;
+
+    /* Descend towards the sibling with the cheapest surface area cost */
+    index = tree->root;
+    while(!kmAABBTreeIsLeaf(&tree->nodes[index])) {
+        const kmAABBTreeNode* node = &tree->nodes[index];
+        const kmAABBTreeNode* c1 = &tree->nodes[node->child1];
+        const kmAABBTreeNode* c2 = &tree->nodes[node->child2];
+        kmScalar area, combinedArea, cost, inheritanceCost, cost1, cost2;
+
+        area = kmAABB3SurfaceArea(&node->aabb);
+        kmAABB3ExpandToContain(&combined, &node->aabb, &leafAABB);
+        combinedArea = kmAABB3SurfaceArea(&combined);
+
+        /* Cost of pairing the leaf with this node */
+        cost = 2.0f * combinedArea;
+
+        /* Minimum cost of pushing the leaf further down */
+        inheritanceCost = 2.0f * (combinedArea - area);
+
+        kmAABB3ExpandToContain(&combined, &leafAABB, &c1->aabb);
+        cost1 = kmAABB3SurfaceArea(&combined) + inheritanceCost;
+        if(!kmAABBTreeIsLeaf(c1)) cost1 -= kmAABB3SurfaceArea(&c1->aabb);
+
+        kmAABB3ExpandToContain(&combined, &leafAABB, &c2->aabb);
+        cost2 = kmAABB3SurfaceArea(&combined) + inheritanceCost;
+        if(!kmAABBTreeIsLeaf(c2)) cost2 -= kmAABB3SurfaceArea(&c2->aabb);
+
+        if(cost < cost1 && cost < cost2) {
+            break;
+        }
+
+        index = (cost1 < cost2) ? node->child1 : node->child2;
+    }
+
+    sibling = index;
+
+    /* May reallocate the pool, so pointers are taken afterwards */
+    newParent = kmAABBTreeAllocateNode(tree);
+    nodes = tree->nodes;
+
+    oldParent = nodes[sibling].parent;
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].userData = NULL;
+    kmAABB3ExpandToContain(&nodes[newParent].aabb, &leafAABB, &nodes[sibling].aabb);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if(oldParent != KM_AABB_TREE_NULL_NODE) {
+        if(nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        } else {
+            nodes[oldParent].child2 = newParent;
+        }
+    } else {
+        tree->root = newParent;
+    }
+
+    kmAABBTreeRefitAncestors(tree, nodes[leaf].parent);
+}
+
+static void kmAABBTreeRemoveLeaf(kmAABBTree* tree, int leaf) {
+    kmAABBTreeNode* nodes = tree->nodes;
+    int parent, grandParent, sibling;
+
+    if(leaf == tree->root) {
+        tree->root = KM_AABB_TREE_NULL_NODE;
+        return;
+    }
+
+    parent = nodes[leaf].parent;
+    grandParent = nodes[parent].parent;
+    sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    if(grandParent != KM_AABB_TREE_NULL_NODE) {
+        /* Replace the parent with the sibling */
+        if(nodes[grandParent].child1 == parent) {
+            nodes[grandParent].child1 = sibling;
+        } else {
+            nodes[grandParent].child2 = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        kmAABBTreeFreeNode(tree, parent);
+
+        kmAABBTreeRefitAncestors(tree, grandParent);
+    } else {
+        tree->root = sibling;
+        nodes[sibling].parent = KM_AABB_TREE_NULL_NODE;
+        kmAABBTreeFreeNode(tree, parent);
+    }
+}
+
+void kmAABBTreeInitialize(kmAABBTree* tree, kmScalar margin, kmScalar displacementMultiplier) {
+    tree->nodes = NULL;
+    tree->root = KM_AABB_TREE_NULL_NODE;
+    tree->nodeCount = 0;
+    tree->nodeCapacity = 0;
+    tree->freeList = KM_AABB_TREE_NULL_NODE;
+    tree->margin = margin;
+    tree->displacementMultiplier = displacementMultiplier;
+}
+
+void kmAABBTreeRelease(kmAABBTree* tree) {
+    free(tree->nodes);
+    kmAABBTreeInitialize(tree, tree->margin, tree->displacementMultiplier);
+}
+
+int kmAABBTreeInsert(kmAABBTree* tree, const kmAABB3* aabb, void* userData) {
+    int proxy;
+    kmAABBTreeNode* node;
+
+    /* The leaf and the parent pairing it with its sibling. Growing up
+     * front means nothing below can fail part way through the insert */
+    if(tree->nodeCapacity - tree->nodeCount < 2 && !kmAABBTreeGrow(tree)) {
+        return KM_AABB_TREE_NULL_NODE;
+    }
+
+    proxy = kmAABBTreeAllocateNode(tree);
+    node = &tree->nodes[proxy];
+
+    kmVec3Fill(&node->aabb.min, aabb->min.x - tree->margin, aabb->min.y - tree->margin, aabb->min.z - tree->margin);
+    kmVec3Fill(&node->aabb.max, aabb->max.x + tree->margin, aabb->max.y + tree->margin, aabb->max.z + tree->margin);
+    node->userData = userData;
+    node->height = 0;
+
+    kmAABBTreeInsertLeaf(tree, proxy);
+
+    return proxy;
+}
+
+void kmAABBTreeRemove(kmAABBTree* tree, int proxy) {
+    assert(0 <= proxy && proxy < tree->nodeCapacity);
+    assert(kmAABBTreeIsLeaf(&tree->nodes[proxy]));
+
+    kmAABBTreeRemoveLeaf(tree, proxy);
+    kmAABBTreeFreeNode(tree, proxy);
+}
+
+kmBool kmAABBTreeMove(kmAABBTree* tree, int proxy, const kmAABB3* aabb, const kmVec3* displacement) {
+    kmAABB3 fat;
+
+    assert(0 <= proxy && proxy < tree->nodeCapacity);
+    assert(kmAABBTreeIsLeaf(&tree->nodes[proxy]));
+
+    if(kmAABB3Encloses(&tree->nodes[proxy].aabb, aabb)) {
+        return KM_FALSE;
+    }
+
+    kmAABBTreeRemoveLeaf(tree, proxy);
+
+    kmVec3Fill(&fat.min, aabb->min.x - tree->margin, aabb->min.y - tree->margin, aabb->min.z - tree->margin);
+    kmVec3Fill(&fat.max, aabb->max.x + tree->margin, aabb->max.y + tree->margin, aabb->max.z + tree->margin);
+
+    /* Stretch the box towards where the object is heading */
+    if(displacement) {
+        kmVec3 d;
+        kmVec3Scale(&d, displacement, tree->displacementMultiplier);
+
+        if(d.x < 0.0f) fat.min.x += d.x; else fat.max.x += d.x;
+        if(d.y < 0.0f) fat.min.y += d.y; else fat.max.y += d.y;
+        if(d.z < 0.0f) fat.min.z += d.z; else fat.max.z += d.z;
+    }
+
+    tree->nodes[proxy].aabb = fat;
+
+    kmAABBTreeInsertLeaf(tree, proxy);
+    return KM_TRUE;
+}
+
+void* kmAABBTreeGetUserData(const kmAABBTree* tree, int proxy) {
+    assert(0 <= proxy && proxy < tree->nodeCapacity);
+    return tree->nodes[proxy].userData;
+}
+
+const kmAABB3* kmAABBTreeGetFatAABB3(const kmAABBTree* tree, int proxy) {
+    assert(0 <= proxy && proxy < tree->nodeCapacity);
+    return &tree->nodes[proxy].aabb;
+}
+
+int kmAABBTreeGetHeight(const kmAABBTree* tree) {
+    if(tree->root == KM_AABB_TREE_NULL_NODE) {
+        return 0;
+    }
+
+    return tree->nodes[tree->root].height;
+}
+
+void kmAABBTreeQueryAABB3(const kmAABBTree* tree, const kmAABB3* aabb, kmAABBTreeQueryCallback callback, void* context) {
+    int stack[STACK_SIZE];
+    int count = 0;
+
+    if(tree->root == KM_AABB_TREE_NULL_NODE) {
+        return;
+    }
+
+    stack[count++] = tree->root;
+
+    while(count) {
+        const kmAABBTreeNode* node = &tree->nodes[stack[--count]];
+
+        if(!kmAABB3IntersectsAABB(&node->aabb, aabb)) {
+            continue;
+        }
+
+        if(kmAABBTreeIsLeaf(node)) {
+            if(!callback(context, (int) (node - tree->nodes))) {
+                return;
+            }
+        } else {
+            assert(count + 2 <= STACK_SIZE);
+            stack[count++] = node->child1;
+            stack[count++] = node->child2;
+        }
+    }
+}
+
+void kmAABBTreeQueryRay3(const kmAABBTree* tree, const kmRay3* ray, kmAABBTreeQueryCallback callback, void* context) {
+    int stack[STACK_SIZE];
+    int count = 0;
+    kmRay3Precomputed pre;
+
+    if(tree->root == KM_AABB_TREE_NULL_NODE) {
+        return;
+    }
+
+    kmRay3PrecomputedFromRay3(&pre, ray);
+    stack[count++] = tree->root;
+
+    while(count) {
+        const kmAABBTreeNode* node = &tree->nodes[stack[--count]];
+
+        if(!kmRay3PrecomputedIntersectAABB3(&pre, &node->aabb, NULL, NULL)) {
+            continue;
+        }
+
+        if(kmAABBTreeIsLeaf(node)) {
+            if(!callback(context, (int) (node - tree->nodes))) {
+                return;
+            }
+        } else {
+            assert(count + 2 <= STACK_SIZE);
+            stack[count++] = node->child1;
+            stack[count++] = node->child2;
+        }
+    }
+}
+
+/* Reports every leaf below index without any further tests */
+static kmBool kmAABBTreeReportSubtree(const kmAABBTree* tree, int index, kmAABBTreeQueryCallback callback, void* context) {
+    int stack[STACK_SIZE];
+    int count = 0;
+
+    stack[count++] = index;
+
+    while(count) {
+        const kmAABBTreeNode* node = &tree->nodes[stack[--count]];
+
+        if(kmAABBTreeIsLeaf(node)) {
+            if(!callback(context, (int) (node - tree->nodes))) {
+                return KM_FALSE;
+            }
+        } else {
+            assert(count + 2 <= STACK_SIZE);
+            stack[count++] = node->child1;
+            stack[count++] = node->child2;
+        }
+    }
+
+    return KM_TRUE;
+}
+
+void kmAABBTreeQueryFrustum(const kmAABBTree* tree, const kmPlane* planes, kmAABBTreeQueryCallback callback, void* context) {
+    int stack[STACK_SIZE];
+    int count = 0;
+
+    if(tree->root == KM_AABB_TREE_NULL_NODE) {
+        return;
+    }
+
+    stack[count++] = tree->root;
+
+    while(count) {
+        int index = stack[--count];
+        const kmAABBTreeNode* node = &tree->nodes[index];
+        kmEnum result = kmAABB3IntersectsFrustum(&node->aabb, planes);
+
+        if(result == KM_CONTAINS_NONE) {
+            continue;
+        }
+
+        if(result == KM_CONTAINS_ALL || kmAABBTreeIsLeaf(node)) {
+            if(!kmAABBTreeReportSubtree(tree, index, callback, context)) {
+                return;
+            }
+        } else {
+            assert(count + 2 <= STACK_SIZE);
+            stack[count++] = node->child1;
+            stack[count++] = node->child2;
+        }
+    }
+}
@@ -0,0 +1,149 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <kazmath/animation.h>
+
+kmBool kmAnimSamplerInitialize(kmAnimSampler* sampler, const kmAnimClip* clip) {
+    sampler->clip = clip;
+    sampler->cursors = (uint32_t*) malloc(sizeof(uint32_t) * (clip->channelCount ? clip->channelCount : 1));
+
+    if(!sampler->cursors) {
+        return KM_FALSE;
+    }
+
+    kmAnimSamplerReset(sampler);
+    return KM_TRUE;
+}
+
+void kmAnimSamplerRelease(kmAnimSampler* sampler) {
+    free(sampler->cursors);
+    sampler->cursors = NULL;
+    sampler->clip = NULL;
+}
+
+void kmAnimSamplerReset(kmAnimSampler* sampler) {
+    uint32_t i;
+
+    for(i = 0; i < sampler->clip->channelCount; ++i) {
+        sampler->cursors[i] = 0;
+    }
+}
+
+/*
+ * Returns the key k, relative to the channel, with times[k] <= time <
+ * times[k + 1], or the last key if time is past it.
+ */
+static uint32_t kmAnimFindKey(const kmScalar* times, uint32_t count, uint32_t cursor, kmScalar time) {
+    uint32_t lo, hi;
+
+    if(cursor >= count || times[cursor] > time) {
+        /* Went backwards, search the keys before the cursor */
+        lo = 0;
+        hi = cursor < count ? cursor : count;
+
+        while(hi - lo > 1) {
+            uint32_t mid = (lo + hi) / 2;
+            if(times[mid] <= time) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+
+        return lo;
+    }
+
+    while(cursor + 1 < count && times[cursor + 1] <= time) {
+        ++cursor;
+    }
+
+    return cursor;
+}
+
+void kmAnimSamplerSample(kmAnimSampler* sampler, kmScalar time, kmBool loop,
+                         kmVec3* translations, kmQuaternion* rotations, kmVec3* scales) {
+    const kmAnimClip* clip = sampler->clip;
+    uint32_t c;
+
+    if(loop && clip->duration > 0.0f) {
+        time = fmodf(time, clip->duration);
+        if(time < 0.0f) {
+            time += clip->duration;
+        }
+    } else {
+        time = kmClamp(time, 0.0f, clip->duration);
+    }
+
+    for(c = 0; c < clip->channelCount; ++c) {
+        const kmAnimChannel* channel = &clip->channels[c];
+        const kmScalar* times = &clip->times[channel->firstKey];
+        uint32_t k, a, b;
+        kmScalar t = 0.0f;
+
+        if(!channel->keyCount) {
+            continue;
+        }
+
+        k = kmAnimFindKey(times, channel->keyCount, sampler->cursors[c], time);
+        sampler->cursors[c] = k;
+
+        a = channel->firstKey + k;
+        b = a;
+
+        if(time < times[k] || k + 1 == channel->keyCount) {
+            /* Outside the keys: clamp, or when looping blend across the
+             * wrap from the last key to the first */
+            if(loop && channel->keyCount > 1) {
+                uint32_t last = channel->keyCount - 1;
+                kmScalar span = clip->duration - times[last] + times[0];
+                kmScalar elapsed = (time >= times[last]) ? time - times[last] : time + clip->duration - times[last];
+
+                a = channel->firstKey + last;
+                b = channel->firstKey;
+                t = (span > 0.0f) ? kmClamp(elapsed / span, 0.0f, 1.0f) : 0.0f;
+            }
+        } else {
+            b = a + 1;
+            if(time > times[k]) {
+                t = (time - times[k]) / (times[k + 1] - times[k]);
+            }
+        }
+
+        if(channel->type == KM_ANIM_ROTATION) {
+            kmQuaternion q1, q2;
+            kmQuaternionFill(&q1, clip->x[a], clip->y[a], clip->z[a], clip->w[a]);
+            kmQuaternionFill(&q2, clip->x[b], clip->y[b], clip->z[b], clip->w[b]);
+            kmQuaternionSlerpFast(&rotations[channel->bone], &q1, &q2, t);
+        } else {
+            kmVec3* out = (channel->type == KM_ANIM_TRANSLATION) ? &translations[channel->bone] : &scales[channel->bone];
+            out->x = kmLerp(clip->x[a], clip->x[b], t);
+            out->y = kmLerp(clip->y[a], clip->y[b], t);
+            out->z = kmLerp(clip->z[a], clip->z[b], t);
+        }
+    }
+}
@@ -0,0 +1,775 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kazmath/bvh.h>
+#include <kazmath/ray3.h>
+
+#define BIN_COUNT 16
+#define MAX_LEAF_SIZE 8
+
+/*
+ * Past this depth the SAH builder switches to median splits, which halve
+ * the primitive count at every level, so no SAH tree is deeper than
+ * MAX_SAH_DEPTH + 32. Linear trees split on the 30 Morton bits and then
+ * at the median of equal codes, so are never deeper than 30 + 32. A
+ * traversal holds at most depth + 1 entries.
+ */
+#define MAX_SAH_DEPTH 24
+#define STACK_SIZE 64
+
+/* Cost of visiting a node relative to testing one primitive */
+#define TRAVERSAL_COST 1.0f
+
+typedef struct kmBVHBuilder {
+    kmBVH* bvh;
+    const kmAABB3* bounds;
+    kmVec3* centroids;
+} kmBVHBuilder;
+
+typedef struct kmBVHBin {
+    kmAABB3 aabb;
+    uint32_t count;
+} kmBVHBin;
+
+static void kmAABB3MakeEmpty(kmAABB3* aabb) {
+    kmVec3Fill(&aabb->min, FLT_MAX, FLT_MAX, FLT_MAX);
+    kmVec3Fill(&aabb->max, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+}
+
+static kmScalar kmVec3Axis(const kmVec3* v, int axis) {
+    return axis == 0 ? v->x : (axis == 1 ? v->y : v->z);
+}
+
+static int kmBVHBinIndex(kmScalar c, kmScalar min, kmScalar scale) {
+    int b = (int) ((c - min) * scale);
+    return b < 0 ? 0 : (b >= BIN_COUNT ? BIN_COUNT - 1 : b);
+}
+
+/* Partially sorts [begin, end) so mid holds the median centroid on axis */
+static void kmBVHSelectMedian(kmBVHBuilder* builder, uint32_t begin, uint32_t end, uint32_t mid, int axis) {
+    uint32_t* prims = builder->bvh->primitives;
+
+    while(end - begin > 1) {
+        kmScalar pivot = kmVec3Axis(&builder->centroids[prims[begin + (end - begin) / 2]], axis);
+        uint32_t i = begin, j = end - 1;
+
+        for(;;) {
+            uint32_t tmp;
+
+            while(kmVec3Axis(&builder->centroids[prims[i]], axis) < pivot) ++i;
+            while(kmVec3Axis(&builder->centroids[prims[j]], axis) > pivot) --j;
+            if(i >= j) {
+                break;
+            }
+
+            tmp = prims[i];
+            prims[i] = prims[j];
+            prims[j] = tmp;
+            ++i;
+            --j;
+        }
+
+        /* [begin, i) <= pivot <= [i, end), and prims[i] is in place if i == j */
+        if(i == j) {
+            if(mid == i) {
+                return;
+            }
+            if(mid < i) {
+                end = i;
+            } else {
+                begin = i + 1;
+            }
+        } else if(mid < i) {
+            end = i;
+        } else {
+            begin = i;
+        }
+    }
+}
+
+static uint32_t kmBVHBuildNode(kmBVHBuilder* builder, uint32_t begin, uint32_t end, uint32_t depth) {
+    kmBVH* bvh = builder->bvh;
+    uint32_t* prims = bvh->primitives;
+    uint32_t index = bvh->nodeCount++;
+    uint32_t count = end - begin;
+    uint32_t i, mid;
+    kmAABB3 centroidBounds;
+    kmScalar bestCost = FLT_MAX, leafCost, area;
+    int bestAxis = -1, bestSplit = 0, axis;
+
+    kmAABB3MakeEmpty(&bvh->nodes[index].aabb);
+    kmAABB3MakeEmpty(&centroidBounds);
+
+    for(i = begin; i < end; ++i) {
+        const kmVec3* c = &builder->centroids[prims[i]];
+        kmAABB3ExpandToContain(&bvh->nodes[index].aabb, &bvh->nodes[index].aabb, &builder->bounds[prims[i]]);
+        centroidBounds.min.x = kmMin(centroidBounds.min.x, c->x);
+        centroidBounds.min.y = kmMin(centroidBounds.min.y, c->y);
+        centroidBounds.min.z = kmMin(centroidBounds.min.z, c->z);
+        centroidBounds.max.x = kmMax(centroidBounds.max.x, c->x);
+        centroidBounds.max.y = kmMax(centroidBounds.max.y, c->y);
+        centroidBounds.max.z = kmMax(centroidBounds.max.z, c->z);
+    }
+
+    bvh->nodes[index].axis = 0;
+
+    if(count == 1) {
+        bvh->nodes[index].offset = begin;
+        bvh->nodes[index].count = 1;
+        return index;
+    }
+
+    if(depth >= MAX_SAH_DEPTH) {
+        /* Keep the tree shallow enough for the traversal stack */
+        if(count <= MAX_LEAF_SIZE) {
+            bvh->nodes[index].offset = begin;
+            bvh->nodes[index].count = (uint16_t) count;
+            return index;
+        }
+
+        kmVec3Subtract(&centroidBounds.max, &centroidBounds.max, &centroidBounds.min);
+        axis = (centroidBounds.max.x >= centroidBounds.max.y && centroidBounds.max.x >= centroidBounds.max.z) ? 0 :
+               (centroidBounds.max.y >= centroidBounds.max.z ? 1 : 2);
+        mid = begin + count / 2;
+        kmBVHSelectMedian(builder, begin, end, mid, axis);
+
+        bvh->nodes[index].axis = (uint16_t) axis;
+        bvh->nodes[index].count = 0;
+        kmBVHBuildNode(builder, begin, mid, depth + 1);
+        bvh->nodes[index].offset = kmBVHBuildNode(builder, mid, end, depth + 1);
+        return index;
+    }
+
+    area = kmAABB3SurfaceArea(&bvh->nodes[index].aabb);
+    leafCost = (kmScalar) count;
+
+    /* Evaluate the binned SAH cost of splitting along each axis */
+    for(axis = 0; axis < 3; ++axis) {
+        kmBVHBin bins[BIN_COUNT];
+        kmScalar leftArea[BIN_COUNT - 1];
+        uint32_t leftCount[BIN_COUNT - 1];
+        kmAABB3 accum;
+        uint32_t n;
+        kmScalar cmin = kmVec3Axis(&centroidBounds.min, axis);
+        kmScalar extent = kmVec3Axis(&centroidBounds.max, axis) - cmin;
+        kmScalar scale;
+        int b;
+
+        if(extent <= 0.0f) {
+            continue;
+        }
+
+        scale = BIN_COUNT / extent;
+
+        for(b = 0; b < BIN_COUNT; ++b) {
+            kmAABB3MakeEmpty(&bins[b].aabb);
+            bins[b].count = 0;
+        }
+
+        for(i = begin; i < end; ++i) {
+            b = kmBVHBinIndex(kmVec3Axis(&builder->centroids[prims[i]], axis), cmin, scale);
+            kmAABB3ExpandToContain(&bins[b].aabb, &bins[b].aabb, &builder->bounds[prims[i]]);
+            ++bins[b].count;
+        }
+
+        /* Sweep from the left, then from the right */
+        kmAABB3MakeEmpty(&accum);
+        n = 0;
+        for(b = 0; b < BIN_COUNT - 1; ++b) {
+            kmAABB3ExpandToContain(&accum, &accum, &bins[b].aabb);
+            n += bins[b].count;
+            leftArea[b] = n ? kmAABB3SurfaceArea(&accum) : 0.0f;
+            leftCount[b] = n;
+        }
+
+        kmAABB3MakeEmpty(&accum);
+        n = 0;
+        for(b = BIN_COUNT - 1; b > 0; --b) {
+            kmScalar cost;
+
+            kmAABB3ExpandToContain(&accum, &accum, &bins[b].aabb);
+            n += bins[b].count;
+
+            if(!n || !leftCount[b - 1]) {
+                continue;
+            }
+
+            cost = TRAVERSAL_COST + (leftArea[b - 1] * leftCount[b - 1] + kmAABB3SurfaceArea(&accum) * n) / area;
+            if(cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b - 1;
+            }
+        }
+    }
+
+    if(bestAxis < 0 || bestCost >= leafCost) {
+        if(count <= MAX_LEAF_SIZE) {
+            bvh->nodes[index].offset = begin;
+            bvh->nodes[index].count = (uint16_t) count;
+            return index;
+        }
+    }
+
+    if(bestAxis < 0) {
+        /* All centroids coincide, just halve the range */
+        mid = begin + count / 2;
+    } else {
+        kmScalar cmin = kmVec3Axis(&centroidBounds.min, bestAxis);
+        kmScalar scale = BIN_COUNT / (kmVec3Axis(&centroidBounds.max, bestAxis) - cmin);
+        uint32_t j = end;
+
+        mid = begin;
+        while(mid < j) {
+            if(kmBVHBinIndex(kmVec3Axis(&builder->centroids[prims[mid]], bestAxis), cmin, scale) <= bestSplit) {
+                ++mid;
+            } else {
+                uint32_t tmp = prims[mid];
+                prims[mid] = prims[--j];
+                prims[j] = tmp;
+            }
+        }
+
+        bvh->nodes[index].axis = (uint16_t) bestAxis;
+    }
+
+    bvh->nodes[index].count = 0;
+    kmBVHBuildNode(builder, begin, mid, depth + 1);
+    bvh->nodes[index].offset = kmBVHBuildNode(builder, mid, end, depth + 1);
+
+    return index;
+}
+
+kmBool kmBVHBuild(kmBVH* bvh, const kmAABB3* bounds, uint32_t count) {
+    kmBVHBuilder builder;
+    uint32_t i;
+
+    memset(bvh, 0, sizeof(kmBVH));
+
+    if(!count) {
+        return KM_TRUE;
+    }
+
+    bvh->nodes = (kmBVHNode*) malloc(sizeof(kmBVHNode) * (2 * count - 1));
+    bvh->primitives = (uint32_t*) malloc(sizeof(uint32_t) * count);
+    builder.centroids = (kmVec3*) malloc(sizeof(kmVec3) * count);
+
+    if(!bvh->nodes || !bvh->primitives || !builder.centroids) {
+        free(builder.centroids);
+        kmBVHRelease(bvh);
+        return KM_FALSE;
+    }
+
+    for(i = 0; i < count; ++i) {
+        bvh->primitives[i] = i;
+        kmAABB3Centre(&bounds[i], &builder.centroids[i]);
+    }
+
+    bvh->primitiveCount = count;
+    builder.bvh = bvh;
+    builder.bounds = bounds;
+
+    kmBVHBuildNode(&builder, 0, count, 0);
+
+    free(builder.centroids);
+
+    /* Give back the space SAH leaves did not need */
+    {
+        kmBVHNode* shrunk = (kmBVHNode*) realloc(bvh->nodes, sizeof(kmBVHNode) * bvh->nodeCount);
+        if(shrunk) bvh->nodes = shrunk;
+    }
+
+    return KM_TRUE;
+}
+
+kmBool kmBVHBuildTriangles(kmBVH* bvh, const kmVec3* vertices, uint32_t* indices, uint32_t triangleCount) {
+    kmAABB3* bounds;
+    uint32_t* sorted;
+    uint32_t i;
+    kmBool result;
+
+    if(!triangleCount) {
+        return kmBVHBuild(bvh, NULL, 0);
+    }
+
+    bounds = (kmAABB3*) malloc(sizeof(kmAABB3) * triangleCount);
+    if(!bounds) {
+        memset(bvh, 0, sizeof(kmBVH));
+        return KM_FALSE;
+    }
+
+    for(i = 0; i < triangleCount; ++i) {
+        const kmVec3* v0 = &vertices[indices[i * 3 + 0]];
+        const kmVec3* v1 = &vertices[indices[i * 3 + 1]];
+        const kmVec3* v2 = &vertices[indices[i * 3 + 2]];
+
+        kmVec3Fill(&bounds[i].min, kmMin(v0->x, kmMin(v1->x, v2->x)), kmMin(v0->y, kmMin(v1->y, v2->y)), kmMin(v0->z, kmMin(v1->z, v2->z)));
+        kmVec3Fill(&bounds[i].max, kmMax(v0->x, kmMax(v1->x, v2->x)), kmMax(v0->y, kmMax(v1->y, v2->y)), kmMax(v0->z, kmMax(v1->z, v2->z)));
+    }
+
+    result = kmBVHBuild(bvh, bounds, triangleCount);
+    free(bounds);
+
+    if(!result) {
+        return KM_FALSE;
+    }
+
+    /* Reorder the index buffer so each leaf's triangles are contiguous */
+    sorted = (uint32_t*) malloc(sizeof(uint32_t) * 3 * triangleCount);
+    if(!sorted) {
+        kmBVHRelease(bvh);
+        return KM_FALSE;
+    }
+
+    for(i = 0; i < triangleCount; ++i) {
+        memcpy(&sorted[i * 3], &indices[bvh->primitives[i] * 3], sizeof(uint32_t) * 3);
+    }
+
+    memcpy(indices, sorted, sizeof(uint32_t) * 3 * triangleCount);
+    free(sorted);
+
+    return KM_TRUE;
+}
+
+/* Spreads the low 10 bits of v out so there are two zeros between each */
+static uint32_t kmMortonExpandBits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+static int kmCountLeadingZeros(uint32_t v) {
+#if defined(__GNUC__)
+    return v ? __builtin_clz(v) : 32;
+#else
+    int n = 0;
+    if(!v) return 32;
+    while(!(v & 0x80000000u)) {
+        v <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/*
+ * Finds where [begin, end) splits: the first primitive whose code has
+ * the highest differing bit set. Also reports the axis of that bit.
+ */
+static uint32_t kmLBVHFindSplit(const uint32_t* codes, uint32_t begin, uint32_t end, uint16_t* axis) {
+    uint32_t first = codes[begin];
+    uint32_t last = codes[end - 1];
+    uint32_t split = begin;
+    uint32_t step = end - 1 - begin;
+    int prefix;
+
+    if(first == last) {
+        *axis = 0;
+        return begin + (end - begin) / 2;
+    }
+
+    prefix = kmCountLeadingZeros(first ^ last);
+
+    /* Bits are interleaved x, y, z from the top of the 30 */
+    *axis = (uint16_t) ((31 - prefix) % 3 == 2 ? 0 : ((31 - prefix) % 3 == 1 ? 1 : 2));
+
+    /* Binary search for the last code sharing more than prefix bits */
+    do {
+        uint32_t newSplit;
+        step = (step + 1) >> 1;
+        newSplit = split + step;
+
+        if(newSplit < end - 1 && kmCountLeadingZeros(first ^ codes[newSplit]) > prefix) {
+            split = newSplit;
+        }
+    } while(step > 1);
+
+    return split + 1;
+}
+
+static void kmLBVHBuildNode(const kmLBVHBuilder* builder, uint32_t index, uint32_t begin, uint32_t end) {
+    kmBVH* bvh = builder->bvh;
+    kmBVHNode* node = &bvh->nodes[index];
+    uint32_t mid;
+
+    if(end - begin == 1) {
+        node->aabb = builder->bounds[bvh->primitives[begin]];
+        node->offset = begin;
+        node->count = 1;
+        node->axis = 0;
+        return;
+    }
+
+    mid = kmLBVHFindSplit(builder->codes, begin, end, &node->axis);
+    node->count = 0;
+    node->offset = index + 2 * (mid - begin);
+
+    kmLBVHBuildNode(builder, index + 1, begin, mid);
+    kmLBVHBuildNode(builder, node->offset, mid, end);
+
+    kmAABB3ExpandToContain(&node->aabb, &bvh->nodes[index + 1].aabb, &bvh->nodes[node->offset].aabb);
+}
+
+kmBool kmLBVHBegin(kmLBVHBuilder* builder, kmBVH* bvh, const kmAABB3* bounds, uint32_t count, uint32_t taskCount) {
+    uint32_t* tmpCodes = NULL;
+    uint32_t* tmpPrims = NULL;
+    kmAABB3 centroidBounds;
+    kmVec3 scale;
+    uint32_t i;
+    int pass;
+
+    memset(bvh, 0, sizeof(kmBVH));
+    builder->bvh = bvh;
+    builder->bounds = bounds;
+    builder->codes = NULL;
+    builder->taskCount = 0;
+
+    if(!count) {
+        return KM_TRUE;
+    }
+
+    bvh->nodes = (kmBVHNode*) malloc(sizeof(kmBVHNode) * (2 * count - 1));
+    bvh->primitives = (uint32_t*) malloc(sizeof(uint32_t) * count);
+    builder->codes = (uint32_t*) malloc(sizeof(uint32_t) * count);
+    tmpCodes = (uint32_t*) malloc(sizeof(uint32_t) * count);
+    tmpPrims = (uint32_t*) malloc(sizeof(uint32_t) * count);
+
+    if(!bvh->nodes || !bvh->primitives || !builder->codes || !tmpCodes || !tmpPrims) {
+        free(tmpCodes);
+        free(tmpPrims);
+        free(builder->codes);
+        builder->codes = NULL;
+        kmBVHRelease(bvh);
+        return KM_FALSE;
+    }
+
+    bvh->nodeCount = 2 * count - 1;
+    bvh->primitiveCount = count;
+
+    /* Quantize centroids to 10 bits per axis within their bounds */
+    kmAABB3MakeEmpty(&centroidBounds);
+    for(i = 0; i < count; ++i) {
+        kmVec3 c;
+        kmAABB3Centre(&bounds[i], &c);
+        centroidBounds.min.x = kmMin(centroidBounds.min.x, c.x);
+        centroidBounds.min.y = kmMin(centroidBounds.min.y, c.y);
+        centroidBounds.min.z = kmMin(centroidBounds.min.z, c.z);
+        centroidBounds.max.x = kmMax(centroidBounds.max.x, c.x);
+        centroidBounds.max.y = kmMax(centroidBounds.max.y, c.y);
+        centroidBounds.max.z = kmMax(centroidBounds.max.z, c.z);
+    }
+
+    kmVec3Subtract(&scale, &centroidBounds.max, &centroidBounds.min);
+    scale.x = scale.x > 0.0f ? 1023.0f / scale.x : 0.0f;
+    scale.y = scale.y > 0.0f ? 1023.0f / scale.y : 0.0f;
+    scale.z = scale.z > 0.0f ? 1023.0f / scale.z : 0.0f;
+
+    for(i = 0; i < count; ++i) {
+        kmVec3 c;
+        kmAABB3Centre(&bounds[i], &c);
+        builder->codes[i] = (kmMortonExpandBits((uint32_t) ((c.x - centroidBounds.min.x) * scale.x)) << 2) |
+                            (kmMortonExpandBits((uint32_t) ((c.y - centroidBounds.min.y) * scale.y)) << 1) |
+                            kmMortonExpandBits((uint32_t) ((c.z - centroidBounds.min.z) * scale.z));
+        bvh->primitives[i] = i;
+    }
+
+    /* LSD radix sort, three passes of 10 bits */
+    for(pass = 0; pass < 3; ++pass) {
+        uint32_t histogram[1024];
+        uint32_t sum = 0;
+        int shift = pass * 10;
+        uint32_t* swap;
+
+        memset(histogram, 0, sizeof(histogram));
+        for(i = 0; i < count; ++i) {
+            ++histogram[(builder->codes[i] >> shift) & 1023];
+        }
+
+        for(i = 0; i < 1024; ++i) {
+            uint32_t c = histogram[i];
+            histogram[i] = sum;
+            sum += c;
+        }
+
+        for(i = 0; i < count; ++i) {
+            uint32_t dst = histogram[(builder->codes[i] >> shift) & 1023]++;
+            tmpCodes[dst] = builder->codes[i];
+            tmpPrims[dst] = bvh->primitives[i];
+        }
+
+        swap = builder->codes; builder->codes = tmpCodes; tmpCodes = swap;
+        swap = bvh->primitives; bvh->primitives = tmpPrims; tmpPrims = swap;
+    }
+
+    free(tmpCodes);
+    free(tmpPrims);
+
+    /* Split the largest task until there are enough of them */
+    if(taskCount < 1) taskCount = 1;
+    if(taskCount > KM_LBVH_MAX_TASKS) taskCount = KM_LBVH_MAX_TASKS;
+
+    builder->tasks[0].node = 0;
+    builder->tasks[0].begin = 0;
+    builder->tasks[0].end = count;
+    builder->taskCount = 1;
+
+    while(builder->taskCount < taskCount) {
+        uint32_t largest = 0, mid;
+        kmLBVHTask task;
+        kmBVHNode* node;
+
+        for(i = 1; i < builder->taskCount; ++i) {
+            if(builder->tasks[i].end - builder->tasks[i].begin > builder->tasks[largest].end - builder->tasks[largest].begin) {
+                largest = i;
+            }
+        }
+
+        task = builder->tasks[largest];
+        if(task.end - task.begin < 2) {
+            break;
+        }
+
+        node = &bvh->nodes[task.node];
+        mid = kmLBVHFindSplit(builder->codes, task.begin, task.end, &node->axis);
+        node->count = 0;
+        node->offset = task.node + 2 * (mid - task.begin);
+
+        builder->tasks[largest].node = task.node + 1;
+        builder->tasks[largest].end = mid;
+
+        builder->tasks[builder->taskCount].node = node->offset;
+        builder->tasks[builder->taskCount].begin = mid;
+        builder->tasks[builder->taskCount].end = task.end;
+        ++builder->taskCount;
+    }
+
+    return KM_TRUE;
+}
+
+void kmLBVHBuildTask(const kmLBVHBuilder* builder, uint32_t task) {
+    const kmLBVHTask* t = &builder->tasks[task];
+    kmLBVHBuildNode(builder, t->node, t->begin, t->end);
+}
+
+static void kmLBVHFitTop(const kmLBVHBuilder* builder, uint32_t index, uint32_t begin, uint32_t end) {
+    kmBVHNode* node = &builder->bvh->nodes[index];
+    uint32_t i, mid;
+
+    for(i = 0; i < builder->taskCount; ++i) {
+        if(builder->tasks[i].node == index) {
+            return;
+        }
+    }
+
+    mid = begin + (node->offset - index) / 2;
+    kmLBVHFitTop(builder, index + 1, begin, mid);
+    kmLBVHFitTop(builder, node->offset, mid, end);
+
+    kmAABB3ExpandToContain(&node->aabb, &builder->bvh->nodes[index + 1].aabb, &builder->bvh->nodes[node->offset].aabb);
+}
+
+void kmLBVHEnd(kmLBVHBuilder* builder) {
+    if(builder->bvh->nodeCount) {
+        kmLBVHFitTop(builder, 0, 0, builder->bvh->primitiveCount);
+    }
+
+    free(builder->codes);
+    builder->codes = NULL;
+    builder->taskCount = 0;
+}
+
+kmBool kmBVHBuildLinear(kmBVH* bvh, const kmAABB3* bounds, uint32_t count) {
+    kmLBVHBuilder builder;
+    uint32_t i;
+
+    if(!kmLBVHBegin(&builder, bvh, bounds, count, 1)) {
+        return KM_FALSE;
+    }
+
+    for(i = 0; i < builder.taskCount; ++i) {
+        kmLBVHBuildTask(&builder, i);
+    }
+
+    kmLBVHEnd(&builder);
+    return KM_TRUE;
+}
+
+void kmBVHRelease(kmBVH* bvh) {
+    free(bvh->nodes);
+    free(bvh->primitives);
+    memset(bvh, 0, sizeof(kmBVH));
+}
+
+void kmBVHQueryAABB3(const kmBVH* bvh, const kmAABB3* aabb, kmBVHQueryCallback callback, void* context) {
+    uint32_t stack[STACK_SIZE];
+    int count = 0;
+
+    if(!bvh->nodeCount) {
+        return;
+    }
+
+    stack[count++] = 0;
+
+    while(count) {
+        uint32_t index = stack[--count];
+        const kmBVHNode* node = &bvh->nodes[index];
+
+        if(!kmAABB3IntersectsAABB(&node->aabb, aabb)) {
+            continue;
+        }
+
+        if(node->count) {
+            uint32_t i;
+            for(i = node->offset; i < node->offset + node->count; ++i) {
+                if(!callback(context, bvh->primitives[i])) {
+                    return;
+                }
+            }
+        } else {
+            assert(count + 2 <= STACK_SIZE);
+            stack[count++] = node->offset;
+            stack[count++] = index + 1;
+        }
+    }
+}
+
+void kmBVHQueryRay3(const kmBVH* bvh, const kmRay3* ray, kmBVHQueryCallback callback, void* context) {
+    uint32_t stack[STACK_SIZE];
+    int count = 0;
+    kmRay3Precomputed pre;
+
+    if(!bvh->nodeCount) {
+        return;
+    }
+
+    kmRay3PrecomputedFromRay3(&pre, ray);
+    stack[count++] = 0;
+
+    while(count) {
+        uint32_t index = stack[--count];
+        const kmBVHNode* node = &bvh->nodes[index];
+
+        if(!kmRay3PrecomputedIntersectAABB3(&pre, &node->aabb, NULL, NULL)) {
+            continue;
+        }
+
+        if(node->count) {
+            uint32_t i;
+            for(i = node->offset; i < node->offset + node->count; ++i) {
+                if(!callback(context, bvh->primitives[i])) {
+                    return;
+                }
+            }
+        } else {
+            assert(count + 2 <= STACK_SIZE);
+            stack[count++] = node->offset;
+            stack[count++] = index + 1;
+        }
+    }
+}
+
+/*
+ * Shared traversal for the triangle queries, visits the nearer child
+ * first and prunes boxes further away than the closest hit so far.
+ */
+static kmBool kmBVHTraverseTriangles(const kmBVH* bvh, const kmRay3* ray, const kmVec3* vertices, const uint32_t* indices, kmBVHHit* hit, kmBool anyHit) {
+    uint32_t stack[STACK_SIZE];
+    int count = 0;
+    kmBool found = KM_FALSE;
+    kmScalar closest = FLT_MAX;
+    const kmScalar dir[3] = { ray->dir.x, ray->dir.y, ray->dir.z };
+    kmRay3Precomputed pre;
+
+    if(!bvh->nodeCount) {
+        return KM_FALSE;
+    }
+
+    /* Triangles are only hit within the length of the ray */
+    kmRay3PrecomputedFromRay3(&pre, ray);
+    pre.tmax = kmVec3Length(&ray->dir);
+    stack[count++] = 0;
+
+    while(count) {
+        uint32_t index = stack[--count];
+        const kmBVHNode* node = &bvh->nodes[index];
+        kmScalar tBox;
+
+        if(!kmRay3PrecomputedIntersectAABB3(&pre, &node->aabb, NULL, &tBox) || tBox > closest) {
+            continue;
+        }
+
+        if(node->count) {
+            uint32_t i;
+            for(i = node->offset; i < node->offset + node->count; ++i) {
+                kmVec3 intersection, normal;
+                kmScalar distance;
+                const uint32_t* tri = &indices[i * 3];
+
+                if(!kmRay3IntersectTriangle(ray, &vertices[tri[0]], &vertices[tri[1]], &vertices[tri[2]], &intersection, &normal, &distance)) {
+                    continue;
+                }
+
+                if(anyHit) {
+                    return KM_TRUE;
+                }
+
+                if(distance < closest) {
+                    closest = distance;
+                    found = KM_TRUE;
+                    hit->intersection = intersection;
+                    hit->normal = normal;
+                    hit->distance = distance;
+                    hit->triangle = bvh->primitives[i];
+                }
+            }
+        } else {
+            assert(count + 2 <= STACK_SIZE);
+            /* Push the far child first so the near one is popped next */
+            if(dir[node->axis] < 0.0f) {
+                stack[count++] = index + 1;
+                stack[count++] = node->offset;
+            } else {
+                stack[count++] = node->offset;
+                stack[count++] = index + 1;
+            }
+        }
+    }
+
+    return found;
+}
+
+kmBool kmBVHIntersectTriangles(const kmBVH* bvh, const kmRay3* ray, const kmVec3* vertices, const uint32_t* indices, kmBVHHit* hit) {
+    return kmBVHTraverseTriangles(bvh, ray, vertices, indices, hit, KM_FALSE);
+}
+
+kmBool kmBVHIntersectTrianglesAny(const kmBVH* bvh, const kmRay3* ray, const kmVec3* vertices, const uint32_t* indices) {
+    return kmBVHTraverseTriangles(bvh, ray, vertices, indices, NULL, KM_TRUE);
+}
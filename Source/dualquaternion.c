@@ -0,0 +1,166 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <kazmath/dualquaternion.h>
+#include <kazmath/mat4.h>
+
+kmDualQuaternion* kmDualQuaternionIdentity(kmDualQuaternion* pOut) {
+    kmQuaternionIdentity(&pOut->real);
+    kmQuaternionFill(&pOut->dual, 0.0f, 0.0f, 0.0f, 0.0f);
+    return pOut;
+}
+
+kmDualQuaternion* kmDualQuaternionFromRotationTranslation(kmDualQuaternion* pOut,
+                                                          const kmQuaternion* rotation,
+                                                          const kmVec3* translation) {
+    kmQuaternion t;
+
+    /* Copy first, rotation may alias pOut->dual */
+    kmQuaternion r = *rotation;
+
+    kmQuaternionFill(&t, translation->x * 0.5f, translation->y * 0.5f, translation->z * 0.5f, 0.0f);
+    kmQuaternionMultiply(&pOut->dual, &t, &r);
+    pOut->real = r;
+    return pOut;
+}
+
+/*
+ * Extracts the rotation of a column major matrix, solving for the
+ * largest component first so that no rotation angle loses precision.
+ */
+static void kmRotationFromMat4(kmQuaternion* pOut, const kmMat4* pIn) {
+    const kmScalar* m = pIn->mat;
+    kmScalar trace = m[0] + m[5] + m[10];
+    kmScalar s;
+
+    if(trace > 0.0f) {
+        s = 0.5f / sqrtf(trace + 1.0f);
+        kmQuaternionFill(pOut, (m[6] - m[9]) * s, (m[8] - m[2]) * s, (m[1] - m[4]) * s, 0.25f / s);
+    } else if(m[0] > m[5] && m[0] > m[10]) {
+        s = 0.5f / sqrtf(1.0f + m[0] - m[5] - m[10]);
+        kmQuaternionFill(pOut, 0.25f / s, (m[4] + m[1]) * s, (m[8] + m[2]) * s, (m[6] - m[9]) * s);
+    } else if(m[5] > m[10]) {
+        s = 0.5f / sqrtf(1.0f + m[5] - m[0] - m[10]);
+        kmQuaternionFill(pOut, (m[4] + m[1]) * s, 0.25f / s, (m[9] + m[6]) * s, (m[8] - m[2]) * s);
+    } else {
+        s = 0.5f / sqrtf(1.0f + m[10] - m[0] - m[5]);
+        kmQuaternionFill(pOut, (m[8] + m[2]) * s, (m[9] + m[6]) * s, 0.25f / s, (m[1] - m[4]) * s);
+    }
+
+    kmQuaternionNormalize(pOut, pOut);
+}
+
+kmDualQuaternion* kmDualQuaternionFromMat4(kmDualQuaternion* pOut, const kmMat4* pIn) {
+    kmQuaternion r;
+    kmVec3 t;
+
+    kmRotationFromMat4(&r, pIn);
+    kmVec3Fill(&t, pIn->mat[12], pIn->mat[13], pIn->mat[14]);
+
+    return kmDualQuaternionFromRotationTranslation(pOut, &r, &t);
+}
+
+kmQuaternion* kmDualQuaternionGetRotation(kmQuaternion* pOut, const kmDualQuaternion* pIn) {
+    return kmQuaternionAssign(pOut, &pIn->real);
+}
+
+kmVec3* kmDualQuaternionGetTranslation(kmVec3* pOut, const kmDualQuaternion* pIn) {
+    const kmQuaternion* r = &pIn->real;
+    const kmQuaternion* d = &pIn->dual;
+
+    /* The vector part of 2 * dual * conjugate(real) */
+    kmScalar x = r->w * d->x - d->w * r->x + (r->y * d->z - r->z * d->y);
+    kmScalar y = r->w * d->y - d->w * r->y + (r->z * d->x - r->x * d->z);
+    kmScalar z = r->w * d->z - d->w * r->z + (r->x * d->y - r->y * d->x);
+
+    return kmVec3Fill(pOut, 2.0f * x, 2.0f * y, 2.0f * z);
+}
+
+kmMat4* kmDualQuaternionToMat4(kmMat4* pOut, const kmDualQuaternion* pIn) {
+    kmVec3 t, s = { 1.0f, 1.0f, 1.0f };
+
+    kmDualQuaternionGetTranslation(&t, pIn);
+    return kmMat4FromTRS(pOut, &t, &pIn->real, &s);
+}
+
+kmDualQuaternion* kmDualQuaternionMultiply(kmDualQuaternion* pOut, const kmDualQuaternion* a,
+                                           const kmDualQuaternion* b) {
+    kmQuaternion real, dual, tmp;
+
+    kmQuaternionMultiply(&real, &a->real, &b->real);
+    kmQuaternionMultiply(&dual, &a->real, &b->dual);
+    kmQuaternionMultiply(&tmp, &a->dual, &b->real);
+    kmQuaternionAdd(&pOut->dual, &dual, &tmp);
+    pOut->real = real;
+    return pOut;
+}
+
+kmDualQuaternion* kmDualQuaternionConjugate(kmDualQuaternion* pOut, const kmDualQuaternion* pIn) {
+    kmQuaternionFill(&pOut->real, -pIn->real.x, -pIn->real.y, -pIn->real.z, pIn->real.w);
+    kmQuaternionFill(&pOut->dual, -pIn->dual.x, -pIn->dual.y, -pIn->dual.z, pIn->dual.w);
+    return pOut;
+}
+
+kmDualQuaternion* kmDualQuaternionNormalize(kmDualQuaternion* pOut, const kmDualQuaternion* pIn) {
+    kmScalar invLength = 1.0f / kmQuaternionLength(&pIn->real);
+    kmQuaternion real, dual;
+    kmScalar d;
+
+    kmQuaternionScale(&real, &pIn->real, invLength);
+    kmQuaternionScale(&dual, &pIn->dual, invLength);
+
+    /* A unit dual quaternion has real . dual == 0 */
+    d = kmQuaternionDot(&real, &dual);
+    dual.x -= real.x * d;
+    dual.y -= real.y * d;
+    dual.z -= real.z * d;
+    dual.w -= real.w * d;
+
+    pOut->real = real;
+    pOut->dual = dual;
+    return pOut;
+}
+
+kmVec3* kmDualQuaternionTransformPoint(kmVec3* pOut, const kmDualQuaternion* dq, const kmVec3* point) {
+    kmVec3 rotated, translation;
+
+    kmDualQuaternionTransformNormal(&rotated, dq, point);
+    kmDualQuaternionGetTranslation(&translation, dq);
+    return kmVec3Add(pOut, &rotated, &translation);
+}
+
+kmVec3* kmDualQuaternionTransformNormal(kmVec3* pOut, const kmDualQuaternion* dq, const kmVec3* normal) {
+    const kmQuaternion* r = &dq->real;
+
+    /* v + 2 * r.xyz x (r.xyz x v + r.w * v) */
+    kmScalar cx = r->y * normal->z - r->z * normal->y + r->w * normal->x;
+    kmScalar cy = r->z * normal->x - r->x * normal->z + r->w * normal->y;
+    kmScalar cz = r->x * normal->y - r->y * normal->x + r->w * normal->z;
+
+    return kmVec3Fill(pOut,
+                      normal->x + 2.0f * (r->y * cz - r->z * cy),
+                      normal->y + 2.0f * (r->z * cx - r->x * cz),
+                      normal->z + 2.0f * (r->x * cy - r->y * cx));
+}
@@ -0,0 +1,384 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kazmath/hashgrid.h>
+#include <kazmath/sphere.h>
+
+#define INITIAL_CELLS 64
+
+/* Cell coordinates are clamped to this so spans and loops cannot overflow */
+#define MAX_COORD (1 << 30)
+
+/* Most cell references a build may make, keeps the table size in range */
+#define MAX_REFERENCES (1u << 30)
+
+static uint32_t kmHashGridHash(int32_t x, int32_t y, int32_t z) {
+    return ((uint32_t) x * 73856093u) ^ ((uint32_t) y * 19349663u) ^ ((uint32_t) z * 83492791u);
+}
+
+static int32_t kmHashGridCoord(const kmHashGrid* grid, kmScalar v) {
+    v = floorf(v * grid->invCellSize);
+
+    /* Written so NaN clamps too */
+    if(!(v >= (kmScalar) -MAX_COORD)) return -MAX_COORD;
+    if(v > (kmScalar) MAX_COORD) return MAX_COORD;
+    return (int32_t) v;
+}
+
+static void kmHashGridCellRange(const kmHashGrid* grid, const kmAABB3* aabb, int32_t* lo, int32_t* hi) {
+    lo[0] = kmHashGridCoord(grid, aabb->min.x);
+    lo[1] = kmHashGridCoord(grid, aabb->min.y);
+    lo[2] = kmHashGridCoord(grid, aabb->min.z);
+    hi[0] = kmHashGridCoord(grid, aabb->max.x);
+    hi[1] = kmHashGridCoord(grid, aabb->max.y);
+    hi[2] = kmHashGridCoord(grid, aabb->max.z);
+}
+
+/*
+ * Number of cells the range covers, or KM_FALSE if that is more than
+ * MAX_REFERENCES.
+ */
+static kmBool kmHashGridCellCount(const int32_t* lo, const int32_t* hi, size_t* pCount) {
+    size_t count = 1;
+    int k;
+
+    for(k = 0; k < 3; ++k) {
+        size_t span;
+
+        if(hi[k] < lo[k]) {
+            *pCount = 0;
+            return KM_TRUE;
+        }
+
+        span = (size_t) ((int64_t) hi[k] - lo[k]) + 1;
+        if(span > MAX_REFERENCES / count) {
+            return KM_FALSE;
+        }
+        count *= span;
+    }
+
+    *pCount = count;
+    return KM_TRUE;
+}
+
+/* Returns the slot of the cell, or of the empty slot where it would go */
+static kmHashGridCell* kmHashGridProbe(const kmHashGrid* grid, int32_t x, int32_t y, int32_t z) {
+    uint32_t mask = grid->cellCapacity - 1;
+    uint32_t slot = kmHashGridHash(x, y, z) & mask;
+
+    for(;;) {
+        kmHashGridCell* cell = &grid->cells[slot];
+        if(!cell->count || (cell->x == x && cell->y == y && cell->z == z)) {
+            return cell;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+static const kmHashGridCell* kmHashGridFind(const kmHashGrid* grid, int32_t x, int32_t y, int32_t z) {
+    const kmHashGridCell* cell;
+
+    if(!grid->cellCapacity) {
+        return NULL;
+    }
+
+    cell = kmHashGridProbe(grid, x, y, z);
+    return cell->count ? cell : NULL;
+}
+
+void kmHashGridInitialize(kmHashGrid* grid, kmScalar cellSize) {
+    grid->cellSize = cellSize;
+    grid->invCellSize = 1.0f / cellSize;
+    grid->boxes = NULL;
+    grid->boxCount = 0;
+    grid->cells = NULL;
+    grid->cellCapacity = 0;
+    grid->entries = NULL;
+    grid->entryCount = 0;
+    grid->entryCapacity = 0;
+}
+
+void kmHashGridRelease(kmHashGrid* grid) {
+    free(grid->cells);
+    free(grid->entries);
+    kmHashGridInitialize(grid, grid->cellSize);
+}
+
+kmBool kmHashGridBuild(kmHashGrid* grid, const kmAABB3* boxes, uint32_t count) {
+    size_t total = 0;
+    uint32_t references;
+    uint32_t capacity = INITIAL_CELLS;
+    uint32_t start = 0;
+    uint32_t i;
+
+    grid->boxes = boxes;
+    grid->boxCount = count;
+    grid->entryCount = 0;
+
+    for(i = 0; i < count; ++i) {
+        int32_t lo[3], hi[3];
+        size_t cells;
+
+        kmHashGridCellRange(grid, &boxes[i], lo, hi);
+        if(!kmHashGridCellCount(lo, hi, &cells) || cells > MAX_REFERENCES - total) {
+            kmHashGridRelease(grid);
+            return KM_FALSE;
+        }
+        total += cells;
+    }
+
+    references = (uint32_t) total;
+
+    /* Keep the table at most half full, at most 2^31 cells */
+    while(capacity < references * 2) {
+        capacity *= 2;
+    }
+
+    /* Only matters where size_t is 32 bits. The entries are smaller */
+    if(capacity > SIZE_MAX / sizeof(kmHashGridCell)) {
+        kmHashGridRelease(grid);
+        return KM_FALSE;
+    }
+
+    if(capacity > grid->cellCapacity) {
+        kmHashGridCell* cells = (kmHashGridCell*) realloc(grid->cells, sizeof(kmHashGridCell) * capacity);
+        if(!cells) {
+            kmHashGridRelease(grid);
+            return KM_FALSE;
+        }
+        grid->cells = cells;
+        grid->cellCapacity = capacity;
+    }
+
+    if(references > grid->entryCapacity) {
+        uint32_t* entries = (uint32_t*) realloc(grid->entries, sizeof(uint32_t) * references);
+        if(!entries) {
+            kmHashGridRelease(grid);
+            return KM_FALSE;
+        }
+        grid->entries = entries;
+        grid->entryCapacity = references;
+    }
+
+    memset(grid->cells, 0, sizeof(kmHashGridCell) * grid->cellCapacity);
+
+    /* Count the entities in each cell */
+    for(i = 0; i < count; ++i) {
+        int32_t lo[3], hi[3], x, y, z;
+        kmHashGridCellRange(grid, &boxes[i], lo, hi);
+
+        for(z = lo[2]; z <= hi[2]; ++z) {
+            for(y = lo[1]; y <= hi[1]; ++y) {
+                for(x = lo[0]; x <= hi[0]; ++x) {
+                    kmHashGridCell* cell = kmHashGridProbe(grid, x, y, z);
+                    cell->x = x;
+                    cell->y = y;
+                    cell->z = z;
+                    ++cell->count;
+                }
+            }
+        }
+    }
+
+    /* Turn the counts into ranges, start is used as a cursor below */
+    for(i = 0; i < grid->cellCapacity; ++i) {
+        grid->cells[i].start = start;
+        start += grid->cells[i].count;
+    }
+
+    for(i = 0; i < count; ++i) {
+        int32_t lo[3], hi[3], x, y, z;
+        kmHashGridCellRange(grid, &boxes[i], lo, hi);
+
+        for(z = lo[2]; z <= hi[2]; ++z) {
+            for(y = lo[1]; y <= hi[1]; ++y) {
+                for(x = lo[0]; x <= hi[0]; ++x) {
+                    kmHashGridCell* cell = kmHashGridProbe(grid, x, y, z);
+                    grid->entries[cell->start++] = i;
+                }
+            }
+        }
+    }
+
+    for(i = 0; i < grid->cellCapacity; ++i) {
+        grid->cells[i].start -= grid->cells[i].count;
+    }
+
+    grid->entryCount = references;
+    return KM_TRUE;
+}
+
+/*
+ * An entity spanning several cells is seen once per cell. It is only
+ * reported from the first cell it shares with the query region, the
+ * per-axis maximum of the two lower corners.
+ */
+static kmBool kmHashGridIsFirstCell(const kmHashGrid* grid, const kmAABB3* aabb, const int32_t* regionLo,
+                                    int32_t x, int32_t y, int32_t z) {
+    int32_t lo[3], hi[3];
+    kmHashGridCellRange(grid, aabb, lo, hi);
+
+    return (lo[0] > regionLo[0] ? lo[0] : regionLo[0]) == x &&
+           (lo[1] > regionLo[1] ? lo[1] : regionLo[1]) == y &&
+           (lo[2] > regionLo[2] ? lo[2] : regionLo[2]) == z;
+}
+
+/*
+ * Touching counts as overlapping, as in kmAABB3IntersectsAABB. Unlike
+ * that this compares the bounds directly, which keeps working for
+ * queries reaching to infinity.
+ */
+static kmBool kmHashGridOverlaps(const kmAABB3* a, const kmAABB3* b) {
+    return a->min.x <= b->max.x && b->min.x <= a->max.x &&
+           a->min.y <= b->max.y && b->min.y <= a->max.y &&
+           a->min.z <= b->max.z && b->min.z <= a->max.z;
+}
+
+/* Reports the entities of cell for a query over aabb, returns KM_FALSE if the callback stopped it */
+static kmBool kmHashGridQueryCell(const kmHashGrid* grid, const kmHashGridCell* cell, const kmAABB3* aabb,
+                                  const int32_t* regionLo, kmHashGridQueryCallback callback, void* context) {
+    uint32_t i;
+
+    for(i = cell->start; i < cell->start + cell->count; ++i) {
+        uint32_t entity = grid->entries[i];
+        const kmAABB3* box = &grid->boxes[entity];
+
+        if(!kmHashGridIsFirstCell(grid, box, regionLo, cell->x, cell->y, cell->z) ||
+           !kmHashGridOverlaps(box, aabb)) {
+            continue;
+        }
+
+        if(!callback(context, entity)) {
+            return KM_FALSE;
+        }
+    }
+
+    return KM_TRUE;
+}
+
+void kmHashGridQueryAABB3(const kmHashGrid* grid, const kmAABB3* aabb,
+                          kmHashGridQueryCallback callback, void* context) {
+    int32_t lo[3], hi[3], x, y, z;
+    size_t cells;
+    uint32_t c;
+
+    kmHashGridCellRange(grid, aabb, lo, hi);
+
+    /* A region with more cells than the table has slots is cheaper to
+     * answer by walking the table, and may be far too big to loop over */
+    if(!kmHashGridCellCount(lo, hi, &cells) || cells > grid->cellCapacity) {
+        for(c = 0; c < grid->cellCapacity; ++c) {
+            const kmHashGridCell* cell = &grid->cells[c];
+
+            if(!cell->count ||
+               cell->x < lo[0] || cell->x > hi[0] ||
+               cell->y < lo[1] || cell->y > hi[1] ||
+               cell->z < lo[2] || cell->z > hi[2]) {
+                continue;
+            }
+
+            if(!kmHashGridQueryCell(grid, cell, aabb, lo, callback, context)) {
+                return;
+            }
+        }
+        return;
+    }
+
+    for(z = lo[2]; z <= hi[2]; ++z) {
+        for(y = lo[1]; y <= hi[1]; ++y) {
+            for(x = lo[0]; x <= hi[0]; ++x) {
+                const kmHashGridCell* cell = kmHashGridFind(grid, x, y, z);
+
+                if(cell && !kmHashGridQueryCell(grid, cell, aabb, lo, callback, context)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+typedef struct kmHashGridRadiusQuery {
+    const kmHashGrid* grid;
+    kmSphere sphere;
+    kmHashGridQueryCallback callback;
+    void* context;
+} kmHashGridRadiusQuery;
+
+static kmBool kmHashGridRadiusFilter(void* context, uint32_t entity) {
+    kmHashGridRadiusQuery* query = (kmHashGridRadiusQuery*) context;
+
+    if(!kmSphereIntersectsAABB3(&query->sphere, &query->grid->boxes[entity])) {
+        return KM_TRUE;
+    }
+
+    return query->callback(query->context, entity);
+}
+
+void kmHashGridQueryRadius(const kmHashGrid* grid, const kmVec3* centre, kmScalar radius,
+                           kmHashGridQueryCallback callback, void* context) {
+    kmHashGridRadiusQuery query;
+    kmAABB3 aabb;
+
+    query.grid = grid;
+    kmSphereFill(&query.sphere, centre, radius);
+    query.callback = callback;
+    query.context = context;
+
+    kmAABB3Initialize(&aabb, centre, radius * 2.0f, radius * 2.0f, radius * 2.0f);
+    kmHashGridQueryAABB3(grid, &aabb, kmHashGridRadiusFilter, &query);
+}
+
+void kmHashGridQueryPairs(const kmHashGrid* grid, kmHashGridPairCallback callback, void* context) {
+    uint32_t c;
+
+    for(c = 0; c < grid->cellCapacity; ++c) {
+        const kmHashGridCell* cell = &grid->cells[c];
+        uint32_t i, j;
+
+        for(i = 0; i < cell->count; ++i) {
+            uint32_t a = grid->entries[cell->start + i];
+            int32_t lo[3], hi[3];
+
+            kmHashGridCellRange(grid, &grid->boxes[a], lo, hi);
+
+            for(j = i + 1; j < cell->count; ++j) {
+                uint32_t b = grid->entries[cell->start + j];
+
+                if(!kmHashGridIsFirstCell(grid, &grid->boxes[b], lo, cell->x, cell->y, cell->z) ||
+                   !kmAABB3IntersectsAABB(&grid->boxes[a], &grid->boxes[b])) {
+                    continue;
+                }
+
+                if(!callback(context, a < b ? a : b, a < b ? b : a)) {
+                    return;
+                }
+            }
+        }
+    }
+}
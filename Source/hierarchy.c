@@ -0,0 +1,186 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <kazmath/hierarchy.h>
+
+#define INITIAL_SIZE 16
+
+void kmTransformHierarchyInitialize(kmTransformHierarchy* hierarchy) {
+    memset(hierarchy, 0, sizeof(kmTransformHierarchy));
+}
+
+void kmTransformHierarchyRelease(kmTransformHierarchy* hierarchy) {
+    free(hierarchy->parents);
+    free(hierarchy->translations);
+    free(hierarchy->rotations);
+    free(hierarchy->scales);
+    free(hierarchy->world);
+    free(hierarchy->inverseWorld);
+    free(hierarchy->dirty);
+    kmTransformHierarchyInitialize(hierarchy);
+}
+
+kmBool kmTransformHierarchyReserve(kmTransformHierarchy* hierarchy, int capacity) {
+    size_t n = (size_t) capacity;
+    void* p;
+
+    if(capacity <= hierarchy->capacity) {
+        return KM_TRUE;
+    }
+
+    /* Each array keeps its old block if the next one fails to grow, so
+     * the hierarchy stays valid at its old capacity */
+    if(!(p = realloc(hierarchy->parents, sizeof(int) * n))) return KM_FALSE;
+    hierarchy->parents = (int*) p;
+    if(!(p = realloc(hierarchy->translations, sizeof(kmVec3) * n))) return KM_FALSE;
+    hierarchy->translations = (kmVec3*) p;
+    if(!(p = realloc(hierarchy->rotations, sizeof(kmQuaternion) * n))) return KM_FALSE;
+    hierarchy->rotations = (kmQuaternion*) p;
+    if(!(p = realloc(hierarchy->scales, sizeof(kmVec3) * n))) return KM_FALSE;
+    hierarchy->scales = (kmVec3*) p;
+    if(!(p = realloc(hierarchy->world, sizeof(kmMat4) * n))) return KM_FALSE;
+    hierarchy->world = (kmMat4*) p;
+    if(!(p = realloc(hierarchy->inverseWorld, sizeof(kmMat4) * n))) return KM_FALSE;
+    hierarchy->inverseWorld = (kmMat4*) p;
+    if(!(p = realloc(hierarchy->dirty, sizeof(kmUchar) * n))) return KM_FALSE;
+    hierarchy->dirty = (kmUchar*) p;
+
+    hierarchy->capacity = capacity;
+    return KM_TRUE;
+}
+
+int kmTransformHierarchyAdd(kmTransformHierarchy* hierarchy, int parent,
+                            const kmVec3* translation, const kmQuaternion* rotation,
+                            const kmVec3* scale) {
+    int node = hierarchy->count;
+
+    if(parent < KM_HIERARCHY_NO_PARENT || parent >= node) {
+        return -1;
+    }
+
+    if(node == hierarchy->capacity &&
+       !kmTransformHierarchyReserve(hierarchy, node ? node * 2 : INITIAL_SIZE)) {
+        return -1;
+    }
+
+    hierarchy->parents[node] = parent;
+    hierarchy->count++;
+    kmTransformHierarchySetLocal(hierarchy, node, translation, rotation, scale);
+    return node;
+}
+
+void kmTransformHierarchySetLocal(kmTransformHierarchy* hierarchy, int node,
+                                  const kmVec3* translation, const kmQuaternion* rotation,
+                                  const kmVec3* scale) {
+    hierarchy->translations[node] = *translation;
+    hierarchy->rotations[node] = *rotation;
+    hierarchy->scales[node] = *scale;
+    hierarchy->dirty[node] = KM_TRUE;
+}
+
+void kmTransformHierarchyMarkDirty(kmTransformHierarchy* hierarchy, int node) {
+    hierarchy->dirty[node] = KM_TRUE;
+}
+
+/*
+ * The inverse of translation * rotation * scale, which is
+ * scale^-1 * rotation^T * translation^-1.
+ */
+static void kmInverseTRS(kmMat4* pOut, const kmVec3* translation,
+                         const kmQuaternion* rotation, const kmVec3* scale) {
+    const kmVec3 zero = { 0.0f, 0.0f, 0.0f };
+    const kmVec3 one = { 1.0f, 1.0f, 1.0f };
+    kmScalar inv[3];
+    kmMat4 r;
+    int row, column;
+
+    kmMat4FromTRS(&r, &zero, rotation, &one);
+
+    inv[0] = 1.0f / scale->x;
+    inv[1] = 1.0f / scale->y;
+    inv[2] = 1.0f / scale->z;
+
+    for(column = 0; column < 3; ++column) {
+        for(row = 0; row < 3; ++row) {
+            pOut->mat[column * 4 + row] = r.mat[row * 4 + column] * inv[row];
+        }
+        pOut->mat[column * 4 + 3] = 0.0f;
+    }
+
+    for(row = 0; row < 3; ++row) {
+        pOut->mat[12 + row] = -(pOut->mat[row] * translation->x +
+                                pOut->mat[4 + row] * translation->y +
+                                pOut->mat[8 + row] * translation->z);
+    }
+    pOut->mat[15] = 1.0f;
+}
+
+int kmTransformHierarchyUpdateRange(kmTransformHierarchy* hierarchy, int begin, int end) {
+    int updated = 0;
+    int i;
+
+    for(i = begin; i < end; ++i) {
+        int parent = hierarchy->parents[i];
+        kmMat4 local, inverseLocal;
+
+        if(!hierarchy->dirty[i] && (parent == KM_HIERARCHY_NO_PARENT || !hierarchy->dirty[parent])) {
+            continue;
+        }
+
+        /* Flag the node so that its children are updated further on */
+        hierarchy->dirty[i] = KM_TRUE;
+        ++updated;
+
+        if(parent == KM_HIERARCHY_NO_PARENT) {
+            kmMat4FromTRS(&hierarchy->world[i], &hierarchy->translations[i],
+                          &hierarchy->rotations[i], &hierarchy->scales[i]);
+            kmInverseTRS(&hierarchy->inverseWorld[i], &hierarchy->translations[i],
+                         &hierarchy->rotations[i], &hierarchy->scales[i]);
+            continue;
+        }
+
+        kmMat4FromTRS(&local, &hierarchy->translations[i], &hierarchy->rotations[i], &hierarchy->scales[i]);
+        kmInverseTRS(&inverseLocal, &hierarchy->translations[i], &hierarchy->rotations[i], &hierarchy->scales[i]);
+        kmMat4Multiply(&hierarchy->world[i], &hierarchy->world[parent], &local);
+        kmMat4Multiply(&hierarchy->inverseWorld[i], &inverseLocal, &hierarchy->inverseWorld[parent]);
+    }
+
+    return updated;
+}
+
+void kmTransformHierarchyClearDirty(kmTransformHierarchy* hierarchy) {
+    if(hierarchy->count) {
+        memset(hierarchy->dirty, 0, sizeof(kmUchar) * (size_t) hierarchy->count);
+    }
+}
+
+int kmTransformHierarchyUpdate(kmTransformHierarchy* hierarchy) {
+    int updated = kmTransformHierarchyUpdateRange(hierarchy, 0, hierarchy->count);
+    kmTransformHierarchyClearDirty(hierarchy);
+    return updated;
+}
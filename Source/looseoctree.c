@@ -0,0 +1,436 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <kazmath/looseoctree.h>
+#include <kazmath/ray3.h>
+#include <kazmath/plane.h>
+
+#define INITIAL_SIZE 16
+#define STACK_SIZE (KM_LOOSE_OCTREE_MAX_DEPTH * 7 + 8)
+
+static kmBool kmLooseOctreeGrowNodes(kmLooseOctree* tree, int capacity) {
+    kmLooseOctreeNode* nodes;
+    int i;
+
+    if(capacity <= tree->nodeCapacity) {
+        return KM_TRUE;
+    }
+
+    nodes = (kmLooseOctreeNode*) realloc(tree->nodes, sizeof(kmLooseOctreeNode) * capacity);
+    if(!nodes) {
+        return KM_FALSE;
+    }
+
+    /* Chain the new nodes onto the front of the free list */
+    for(i = tree->nodeCapacity; i < capacity - 1; ++i) {
+        nodes[i].parent = i + 1;
+    }
+    nodes[capacity - 1].parent = tree->freeNodes;
+    tree->freeNodes = tree->nodeCapacity;
+
+    tree->nodes = nodes;
+    tree->nodeCapacity = capacity;
+    return KM_TRUE;
+}
+
+static kmBool kmLooseOctreeGrowObjects(kmLooseOctree* tree, int capacity) {
+    kmLooseOctreeObject* objects;
+    int i;
+
+    if(capacity <= tree->objectCapacity) {
+        return KM_TRUE;
+    }
+
+    objects = (kmLooseOctreeObject*) realloc(tree->objects, sizeof(kmLooseOctreeObject) * capacity);
+    if(!objects) {
+        return KM_FALSE;
+    }
+
+    for(i = tree->objectCapacity; i < capacity; ++i) {
+        objects[i].node = KM_LOOSE_OCTREE_NULL;
+        objects[i].next = i + 1;
+    }
+    objects[capacity - 1].next = tree->freeObjects;
+    tree->freeObjects = tree->objectCapacity;
+
+    tree->objects = objects;
+    tree->objectCapacity = capacity;
+    return KM_TRUE;
+}
+
+/* Takes a node from the pool for the cell centre +/- halfSize */
+static int kmLooseOctreeAllocateNode(kmLooseOctree* tree, int parent, int depth, const kmVec3* centre, kmScalar halfSize) {
+    kmLooseOctreeNode* node;
+    kmScalar loose = halfSize * tree->looseness;
+    int id, i;
+
+    if(tree->freeNodes == KM_LOOSE_OCTREE_NULL &&
+       !kmLooseOctreeGrowNodes(tree, tree->nodeCapacity ? tree->nodeCapacity * 2 : INITIAL_SIZE)) {
+        return KM_LOOSE_OCTREE_NULL;
+    }
+
+    id = tree->freeNodes;
+    node = &tree->nodes[id];
+    tree->freeNodes = node->parent;
+
+    kmVec3Fill(&node->looseBounds.min, centre->x - loose, centre->y - loose, centre->z - loose);
+    kmVec3Fill(&node->looseBounds.max, centre->x + loose, centre->y + loose, centre->z + loose);
+    node->parent = parent;
+    for(i = 0; i < 8; ++i) {
+        node->children[i] = KM_LOOSE_OCTREE_NULL;
+    }
+    node->firstObject = KM_LOOSE_OCTREE_NULL;
+    node->objectCount = 0;
+    node->depth = depth;
+
+    return id;
+}
+
+static void kmLooseOctreeFreeSubtree(kmLooseOctree* tree, int id) {
+    kmLooseOctreeNode* node = &tree->nodes[id];
+    int i;
+
+    for(i = 0; i < 8; ++i) {
+        if(node->children[i] != KM_LOOSE_OCTREE_NULL) {
+            kmLooseOctreeFreeSubtree(tree, node->children[i]);
+        }
+    }
+
+    node->parent = tree->freeNodes;
+    tree->freeNodes = id;
+}
+
+void kmLooseOctreeInitialize(kmLooseOctree* tree, const kmVec3* centre, kmScalar halfSize,
+                             kmScalar looseness, int maxDepth) {
+    assert(looseness > 1.0f);
+
+    tree->nodes = NULL;
+    tree->nodeCapacity = 0;
+    tree->freeNodes = KM_LOOSE_OCTREE_NULL;
+    tree->objects = NULL;
+    tree->objectCapacity = 0;
+    tree->freeObjects = KM_LOOSE_OCTREE_NULL;
+    tree->root = KM_LOOSE_OCTREE_NULL;
+    kmVec3Assign(&tree->centre, centre);
+    tree->halfSize = halfSize;
+    tree->looseness = looseness;
+    tree->maxDepth = maxDepth < 0 ? 0 : (maxDepth > KM_LOOSE_OCTREE_MAX_DEPTH ? KM_LOOSE_OCTREE_MAX_DEPTH : maxDepth);
+}
+
+void kmLooseOctreeRelease(kmLooseOctree* tree) {
+    kmVec3 centre = tree->centre;
+
+    free(tree->nodes);
+    free(tree->objects);
+    kmLooseOctreeInitialize(tree, &centre, tree->halfSize, tree->looseness, tree->maxDepth);
+}
+
+kmBool kmLooseOctreeReserve(kmLooseOctree* tree, int nodes, int objects) {
+    return kmLooseOctreeGrowNodes(tree, nodes) && kmLooseOctreeGrowObjects(tree, objects);
+}
+
+/*
+ * Finds the node for aabb, creating the path to it. A node at depth d
+ * has cells of size s = 2 * halfSize / 2^d, and an object whose centre
+ * is in the cell fits its loose bounds while its largest half extent
+ * is at most (looseness - 1) * s / 2, which gives the depth directly.
+ * If a node cannot be allocated the object stays at the deepest node
+ * reached, whose loose bounds contain those of the node below.
+ */
+static int kmLooseOctreeFindNode(kmLooseOctree* tree, const kmAABB3* aabb) {
+    kmVec3 centre, extent;
+    kmScalar radius, size = tree->halfSize * 2.0f;
+    kmScalar fx, fy, fz;
+    int depth = tree->maxDepth;
+    int node = tree->root;
+    int level, ix, iy, iz;
+
+    kmAABB3Centre(aabb, &centre);
+    extent.x = (aabb->max.x - aabb->min.x) * 0.5f;
+    extent.y = (aabb->max.y - aabb->min.y) * 0.5f;
+    extent.z = (aabb->max.z - aabb->min.z) * 0.5f;
+    radius = kmMax(extent.x, kmMax(extent.y, extent.z));
+
+    /* Clamped before converting, the log is infinite for an infinite or
+     * denormal radius and NaN lands at the root */
+    if(radius > 0.0f) {
+        kmScalar fit = floorf(log2f((tree->looseness - 1.0f) * size / (2.0f * radius)));
+        depth = fit > 0.0f ? (fit < (kmScalar) depth ? (int) fit : depth) : 0;
+    }
+
+    /* Position of the centre in the region, 0 to 1 on each axis */
+    fx = (centre.x - (tree->centre.x - tree->halfSize)) / size;
+    fy = (centre.y - (tree->centre.y - tree->halfSize)) / size;
+    fz = (centre.z - (tree->centre.z - tree->halfSize)) / size;
+
+    if(!(fx >= 0.0f && fx < 1.0f && fy >= 0.0f && fy < 1.0f && fz >= 0.0f && fz < 1.0f)) {
+        return node;
+    }
+
+    ix = (int) (fx * (1 << depth));
+    iy = (int) (fy * (1 << depth));
+    iz = (int) (fz * (1 << depth));
+
+    /* Walk down following the bits of the cell coordinates */
+    for(level = 1; level <= depth; ++level) {
+        int shift = depth - level;
+        int octant = ((ix >> shift) & 1) | (((iy >> shift) & 1) << 1) | (((iz >> shift) & 1) << 2);
+        int child = tree->nodes[node].children[octant];
+
+        if(child == KM_LOOSE_OCTREE_NULL) {
+            kmScalar half = tree->halfSize / (kmScalar) (1 << level);
+            kmVec3 c;
+
+            c.x = tree->centre.x - tree->halfSize + ((ix >> shift) * 2 + 1) * half;
+            c.y = tree->centre.y - tree->halfSize + ((iy >> shift) * 2 + 1) * half;
+            c.z = tree->centre.z - tree->halfSize + ((iz >> shift) * 2 + 1) * half;
+
+            child = kmLooseOctreeAllocateNode(tree, node, level, &c, half);
+            if(child == KM_LOOSE_OCTREE_NULL) {
+                break;
+            }
+            tree->nodes[node].children[octant] = child;
+        }
+
+        node = child;
+    }
+
+    return node;
+}
+
+static void kmLooseOctreeLink(kmLooseOctree* tree, int proxy, int node) {
+    kmLooseOctreeObject* object = &tree->objects[proxy];
+    int n;
+
+    object->node = node;
+    object->prev = KM_LOOSE_OCTREE_NULL;
+    object->next = tree->nodes[node].firstObject;
+    if(object->next != KM_LOOSE_OCTREE_NULL) {
+        tree->objects[object->next].prev = proxy;
+    }
+    tree->nodes[node].firstObject = proxy;
+
+    for(n = node; n != KM_LOOSE_OCTREE_NULL; n = tree->nodes[n].parent) {
+        ++tree->nodes[n].objectCount;
+    }
+}
+
+/* Unlinks the object and returns emptied branches to the pool */
+static void kmLooseOctreeUnlink(kmLooseOctree* tree, int proxy) {
+    kmLooseOctreeObject* object = &tree->objects[proxy];
+    int empty = KM_LOOSE_OCTREE_NULL;
+    int n;
+
+    if(object->prev != KM_LOOSE_OCTREE_NULL) {
+        tree->objects[object->prev].next = object->next;
+    } else {
+        tree->nodes[object->node].firstObject = object->next;
+    }
+    if(object->next != KM_LOOSE_OCTREE_NULL) {
+        tree->objects[object->next].prev = object->prev;
+    }
+
+    for(n = object->node; n != KM_LOOSE_OCTREE_NULL; n = tree->nodes[n].parent) {
+        if(--tree->nodes[n].objectCount == 0 && n != tree->root) {
+            empty = n;
+        }
+    }
+
+    if(empty != KM_LOOSE_OCTREE_NULL) {
+        kmLooseOctreeNode* parent = &tree->nodes[tree->nodes[empty].parent];
+        int i;
+
+        for(i = 0; i < 8; ++i) {
+            if(parent->children[i] == empty) {
+                parent->children[i] = KM_LOOSE_OCTREE_NULL;
+            }
+        }
+        kmLooseOctreeFreeSubtree(tree, empty);
+    }
+
+    object->node = KM_LOOSE_OCTREE_NULL;
+}
+
+int kmLooseOctreeInsert(kmLooseOctree* tree, const kmAABB3* aabb, void* userData) {
+    int proxy;
+
+    if(tree->root == KM_LOOSE_OCTREE_NULL) {
+        tree->root = kmLooseOctreeAllocateNode(tree, KM_LOOSE_OCTREE_NULL, 0, &tree->centre, tree->halfSize);
+        if(tree->root == KM_LOOSE_OCTREE_NULL) {
+            return KM_LOOSE_OCTREE_NULL;
+        }
+    }
+
+    if(tree->freeObjects == KM_LOOSE_OCTREE_NULL &&
+       !kmLooseOctreeGrowObjects(tree, tree->objectCapacity ? tree->objectCapacity * 2 : INITIAL_SIZE)) {
+        return KM_LOOSE_OCTREE_NULL;
+    }
+
+    proxy = tree->freeObjects;
+    tree->freeObjects = tree->objects[proxy].next;
+
+    tree->objects[proxy].aabb = *aabb;
+    tree->objects[proxy].userData = userData;
+    kmLooseOctreeLink(tree, proxy, kmLooseOctreeFindNode(tree, aabb));
+
+    return proxy;
+}
+
+void kmLooseOctreeRemove(kmLooseOctree* tree, int proxy) {
+    assert(0 <= proxy && proxy < tree->objectCapacity);
+    assert(tree->objects[proxy].node != KM_LOOSE_OCTREE_NULL);
+
+    kmLooseOctreeUnlink(tree, proxy);
+    tree->objects[proxy].next = tree->freeObjects;
+    tree->freeObjects = proxy;
+}
+
+static kmBool kmLooseOctreeEncloses(const kmAABB3* outer, const kmAABB3* inner) {
+    return outer->min.x <= inner->min.x && outer->min.y <= inner->min.y && outer->min.z <= inner->min.z &&
+           outer->max.x >= inner->max.x && outer->max.y >= inner->max.y && outer->max.z >= inner->max.z;
+}
+
+kmBool kmLooseOctreeMove(kmLooseOctree* tree, int proxy, const kmAABB3* aabb) {
+    kmLooseOctreeObject* object;
+
+    assert(0 <= proxy && proxy < tree->objectCapacity);
+    object = &tree->objects[proxy];
+    assert(object->node != KM_LOOSE_OCTREE_NULL);
+
+    object->aabb = *aabb;
+
+    if(object->node == tree->root || kmLooseOctreeEncloses(&tree->nodes[object->node].looseBounds, aabb)) {
+        /* Objects at the root that now fit deeper are moved down */
+        if(object->node != tree->root || kmLooseOctreeFindNode(tree, aabb) == tree->root) {
+            return KM_FALSE;
+        }
+    }
+
+    kmLooseOctreeUnlink(tree, proxy);
+    kmLooseOctreeLink(tree, proxy, kmLooseOctreeFindNode(tree, aabb));
+    return KM_TRUE;
+}
+
+void* kmLooseOctreeGetUserData(const kmLooseOctree* tree, int proxy) {
+    assert(0 <= proxy && proxy < tree->objectCapacity);
+    return tree->objects[proxy].userData;
+}
+
+const kmAABB3* kmLooseOctreeGetAABB3(const kmLooseOctree* tree, int proxy) {
+    assert(0 <= proxy && proxy < tree->objectCapacity);
+    return &tree->objects[proxy].aabb;
+}
+
+/*
+ * The queries share one traversal. test classifies a box against the
+ * query as KM_CONTAINS_NONE, PARTIAL or ALL; once a node is ALL its
+ * objects and everything below it are reported without testing. The
+ * root is always visited as it may hold objects outside the region.
+ */
+typedef kmEnum (*kmLooseOctreeTest)(const void* query, const kmAABB3* aabb);
+
+static void kmLooseOctreeTraverse(const kmLooseOctree* tree, kmLooseOctreeTest test, const void* query,
+                                  kmLooseOctreeQueryCallback callback, void* context) {
+    int stack[STACK_SIZE];
+    kmBool inside[STACK_SIZE];
+    int count = 0;
+
+    if(tree->root == KM_LOOSE_OCTREE_NULL) {
+        return;
+    }
+
+    stack[count] = tree->root;
+    inside[count++] = KM_FALSE;
+
+    while(count) {
+        const kmLooseOctreeNode* node = &tree->nodes[stack[--count]];
+        kmBool all = inside[count];
+        int i;
+
+        if(!all && node != &tree->nodes[tree->root]) {
+            kmEnum result = test(query, &node->looseBounds);
+            if(result == KM_CONTAINS_NONE) {
+                continue;
+            }
+            all = (result == KM_CONTAINS_ALL);
+        }
+
+        for(i = node->firstObject; i != KM_LOOSE_OCTREE_NULL; i = tree->objects[i].next) {
+            if(!all && test(query, &tree->objects[i].aabb) == KM_CONTAINS_NONE) {
+                continue;
+            }
+            if(!callback(context, i)) {
+                return;
+            }
+        }
+
+        for(i = 0; i < 8; ++i) {
+            if(node->children[i] != KM_LOOSE_OCTREE_NULL) {
+                assert(count < STACK_SIZE);
+                stack[count] = node->children[i];
+                inside[count++] = all;
+            }
+        }
+    }
+}
+
+static kmEnum kmLooseOctreeTestAABB3(const void* query, const kmAABB3* aabb) {
+    const kmAABB3* box = (const kmAABB3*) query;
+
+    if(!kmAABB3IntersectsAABB(box, aabb)) {
+        return KM_CONTAINS_NONE;
+    }
+    return kmLooseOctreeEncloses(box, aabb) ? KM_CONTAINS_ALL : KM_CONTAINS_PARTIAL;
+}
+
+static kmEnum kmLooseOctreeTestRay3(const void* query, const kmAABB3* aabb) {
+    const kmRay3Precomputed* ray = (const kmRay3Precomputed*) query;
+    return kmRay3PrecomputedIntersectAABB3(ray, aabb, NULL, NULL) ? KM_CONTAINS_PARTIAL : KM_CONTAINS_NONE;
+}
+
+static kmEnum kmLooseOctreeTestFrustum(const void* query, const kmAABB3* aabb) {
+    return kmAABB3IntersectsFrustum(aabb, (const kmPlane*) query);
+}
+
+void kmLooseOctreeQueryAABB3(const kmLooseOctree* tree, const kmAABB3* aabb,
+                             kmLooseOctreeQueryCallback callback, void* context) {
+    kmLooseOctreeTraverse(tree, kmLooseOctreeTestAABB3, aabb, callback, context);
+}
+
+void kmLooseOctreeQueryRay3(const kmLooseOctree* tree, const kmRay3* ray,
+                            kmLooseOctreeQueryCallback callback, void* context) {
+    kmRay3Precomputed pre;
+    kmRay3PrecomputedFromRay3(&pre, ray);
+    kmLooseOctreeTraverse(tree, kmLooseOctreeTestRay3, &pre, callback, context);
+}
+
+void kmLooseOctreeQueryFrustum(const kmLooseOctree* tree, const kmPlane* planes,
+                               kmLooseOctreeQueryCallback callback, void* context) {
+    kmLooseOctreeTraverse(tree, kmLooseOctreeTestFrustum, planes, callback, context);
+}
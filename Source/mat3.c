@@ -86,12 +86,12 @@ kmMat3* kmMat3Inverse(kmMat3* pOut, const kmMat3* pM)
     kmScalar detInv;
     kmMat3 adjugate;
 
-    if(determinate == 0.0)
+    if(determinate == 0.0f)
     {
         return NULL;
     }
 
-    detInv = 1.0 / determinate;
+    detInv = 1.0f / determinate;
 
     kmMat3Adjugate(&adjugate, pM);
     kmMat3MultiplyScalar(pOut, &adjugate, detInv);
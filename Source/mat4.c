@@ -173,7 +173,7 @@ kmMat4* kmMat4Inverse(kmMat4* pOut, const kmMat4* pM) {
         return NULL;
     }
 
-    det = 1.0 / det;
+    det = 1.0f / det;
 
     for (i = 0; i < 16; i++) {
         pOut->mat[i] = tmp.mat[i] * det;
@@ -411,41 +411,87 @@ kmMat4* kmMat4RotationYawPitchRoll(kmMat4* pOut, const kmScalar pitch, const kmS
 
 kmMat4* kmMat4RotationQuaternion(kmMat4* pOut, const kmQuaternion* pQ)
 {
-    double xx = pQ->x * pQ->x;
-    double xy = pQ->x * pQ->y;
-    double xz = pQ->x * pQ->z;
-    double xw = pQ->x * pQ->w;
-
-    double yy = pQ->y * pQ->y;
-    double yz = pQ->y * pQ->z;
-    double yw = pQ->y * pQ->w;
-
-    double zz = pQ->z * pQ->z;
-    double zw = pQ->z * pQ->w;
-
-    pOut->mat[0] = 1 - 2 * (yy + zz);
-    pOut->mat[1] = 2 * (xy + zw);
-    pOut->mat[2] = 2 * (xz - yw);
-    pOut->mat[3] = 0;
-
-    pOut->mat[4] = 2 * (xy - zw);
-    pOut->mat[5] = 1 - 2 * (xx + zz);
-    pOut->mat[6] = 2 * (yz + xw);
-    pOut->mat[7] = 0.0;
+    kmScalar xx = pQ->x * pQ->x;
+    kmScalar xy = pQ->x * pQ->y;
+    kmScalar xz = pQ->x * pQ->z;
+    kmScalar xw = pQ->x * pQ->w;
 
-    pOut->mat[8] = 2 * (xz + yw);
-    pOut->mat[9] = 2 * (yz - xw);
-    pOut->mat[10] = 1 - 2 * (xx + yy);
-    pOut->mat[11] = 0.0;
+    kmScalar yy = pQ->y * pQ->y;
+    kmScalar yz = pQ->y * pQ->z;
+    kmScalar yw = pQ->y * pQ->w;
 
-    pOut->mat[12] = 0.0;
-    pOut->mat[13] = 0.0;
-    pOut->mat[14] = 0.0;
-    pOut->mat[15] = 1.0;
+    kmScalar zz = pQ->z * pQ->z;
+    kmScalar zw = pQ->z * pQ->w;
+
+    pOut->mat[0] = 1.0f - 2.0f * (yy + zz);
+    pOut->mat[1] = 2.0f * (xy + zw);
+    pOut->mat[2] = 2.0f * (xz - yw);
+    pOut->mat[3] = 0.0f;
+
+    pOut->mat[4] = 2.0f * (xy - zw);
+    pOut->mat[5] = 1.0f - 2.0f * (xx + zz);
+    pOut->mat[6] = 2.0f * (yz + xw);
+    pOut->mat[7] = 0.0f;
+
+    pOut->mat[8] = 2.0f * (xz + yw);
+    pOut->mat[9] = 2.0f * (yz - xw);
+    pOut->mat[10] = 1.0f - 2.0f * (xx + yy);
+    pOut->mat[11] = 0.0f;
+
+    pOut->mat[12] = 0.0f;
+    pOut->mat[13] = 0.0f;
+    pOut->mat[14] = 0.0f;
+    pOut->mat[15] = 1.0f;
 
     return pOut;
 }
 
+kmMat4* kmMat4FromTRS(kmMat4* pOut, const kmVec3* translation,
+                      const kmQuaternion* rotation, const kmVec3* scale)
+{
+    kmScalar x2 = rotation->x + rotation->x;
+    kmScalar y2 = rotation->y + rotation->y;
+    kmScalar z2 = rotation->z + rotation->z;
+
+    kmScalar xx = rotation->x * x2, xy = rotation->x * y2, xz = rotation->x * z2;
+    kmScalar yy = rotation->y * y2, yz = rotation->y * z2, zz = rotation->z * z2;
+    kmScalar wx = rotation->w * x2, wy = rotation->w * y2, wz = rotation->w * z2;
+
+    /* The columns of the rotation, each scaled by one axis of scale */
+    pOut->mat[0] = (1.0f - (yy + zz)) * scale->x;
+    pOut->mat[1] = (xy + wz) * scale->x;
+    pOut->mat[2] = (xz - wy) * scale->x;
+    pOut->mat[3] = 0.0f;
+
+    pOut->mat[4] = (xy - wz) * scale->y;
+    pOut->mat[5] = (1.0f - (xx + zz)) * scale->y;
+    pOut->mat[6] = (yz + wx) * scale->y;
+    pOut->mat[7] = 0.0f;
+
+    pOut->mat[8] = (xz + wy) * scale->z;
+    pOut->mat[9] = (yz - wx) * scale->z;
+    pOut->mat[10] = (1.0f - (xx + yy)) * scale->z;
+    pOut->mat[11] = 0.0f;
+
+    pOut->mat[12] = translation->x;
+    pOut->mat[13] = translation->y;
+    pOut->mat[14] = translation->z;
+    pOut->mat[15] = 1.0f;
+
+    return pOut;
+}
+
+void kmMat4FromTRSArray(kmMat4* pOut, const kmVec3* translations,
+                        const kmQuaternion* rotations, const kmVec3* scales,
+                        size_t count)
+{
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmMat4FromTRS(&pOut[i], &translations[i], &rotations[i], &scales[i]);
+    }
+}
+
 kmMat4* kmMat4Scaling(kmMat4* pOut, const kmScalar x, const kmScalar y,
                       kmScalar z)
 {
@@ -510,7 +556,7 @@ kmMat4* kmMat4PerspectiveProjection(kmMat4* pOut, kmScalar fovY,
 {
 	kmScalar r = kmDegreesToRadians(fovY / 2);
     kmScalar deltaZ = zNear - zFar;
-	kmScalar s = sin(r);
+	kmScalar s = sinf(r);
 	kmScalar cotangent = 0;
 
 	if (deltaZ == 0 || s == 0 || aspect == 0) {
@@ -518,7 +564,7 @@ kmMat4* kmMat4PerspectiveProjection(kmMat4* pOut, kmScalar fovY,
 	}
 
     /*cos(r) / sin(r) = cot(r)*/
-	cotangent = cos(r) / s;
+	cotangent = cosf(r) / s;
 
 	kmMat4Identity(pOut);
 	pOut->mat[0] = cotangent / aspect;
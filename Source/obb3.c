@@ -0,0 +1,376 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <kazmath/obb3.h>
+#include <kazmath/aabb3.h>
+#include <kazmath/mat3.h>
+#include <kazmath/mat4.h>
+
+#include "stride.h"
+
+/* Element (row, col) of a column major kmMat3 */
+#define KM_MAT3(m, row, col) ((m)->mat[(col) * 3 + (row)])
+
+static kmScalar kmOBB3Extent(const kmOBB3* obb, int i) {
+    return i == 0 ? obb->halfExtents.x : (i == 1 ? obb->halfExtents.y : obb->halfExtents.z);
+}
+
+/*
+ * Diagonalizes the symmetric matrix a with cyclic Jacobi rotations.
+ * On return the diagonal of a holds the eigenvalues and the columns
+ * of v the matching eigenvectors.
+ */
+static void kmMat3SymmetricEigen(kmMat3* a, kmMat3* v) {
+    int n, i, j, p, q;
+    kmScalar prevOff = FLT_MAX;
+    kmScalar norm = 0.0f, threshold;
+
+    kmMat3Identity(v);
+
+    /* Off-diagonal terms below float resolution relative to the whole
+     * matrix are zero for our purposes, whatever the scale of the points */
+    for(i = 0; i < 9; ++i) {
+        norm += a->mat[i] * a->mat[i];
+    }
+    threshold = kmEpsilon * sqrtf(norm);
+
+    for(n = 0; n < 50; ++n) {
+        kmScalar off = 0.0f;
+        kmScalar c, s;
+
+        /* Pick the largest off-diagonal element */
+        p = 0; q = 1;
+        for(i = 0; i < 3; ++i) {
+            for(j = i + 1; j < 3; ++j) {
+                if(fabsf(KM_MAT3(a, i, j)) > fabsf(KM_MAT3(a, p, q))) {
+                    p = i;
+                    q = j;
+                }
+            }
+        }
+
+        if(fabsf(KM_MAT3(a, p, q)) <= threshold) {
+            break;
+        }
+
+        /* 2x2 symmetric Schur decomposition for the (p, q) pair */
+        {
+            kmScalar r = (KM_MAT3(a, q, q) - KM_MAT3(a, p, p)) / (2.0f * KM_MAT3(a, p, q));
+            kmScalar t = (r >= 0.0f) ?
+                1.0f / (r + sqrtf(1.0f + r * r)) :
+                -1.0f / (-r + sqrtf(1.0f + r * r));
+            c = 1.0f / sqrtf(1.0f + t * t);
+            s = t * c;
+        }
+
+        /* v = v * J and a = J^T * a * J */
+        for(i = 0; i < 3; ++i) {
+            kmScalar vp = KM_MAT3(v, i, p);
+            kmScalar vq = KM_MAT3(v, i, q);
+            KM_MAT3(v, i, p) = c * vp - s * vq;
+            KM_MAT3(v, i, q) = s * vp + c * vq;
+        }
+
+        for(i = 0; i < 3; ++i) {
+            kmScalar ap = KM_MAT3(a, i, p);
+            kmScalar aq = KM_MAT3(a, i, q);
+            KM_MAT3(a, i, p) = c * ap - s * aq;
+            KM_MAT3(a, i, q) = s * ap + c * aq;
+        }
+
+        for(i = 0; i < 3; ++i) {
+            kmScalar ap = KM_MAT3(a, p, i);
+            kmScalar aq = KM_MAT3(a, q, i);
+            KM_MAT3(a, p, i) = c * ap - s * aq;
+            KM_MAT3(a, q, i) = s * ap + c * aq;
+        }
+
+        for(i = 0; i < 3; ++i) {
+            for(j = 0; j < 3; ++j) {
+                if(i != j) off += KM_MAT3(a, i, j) * KM_MAT3(a, i, j);
+            }
+        }
+
+        /* Stop once the off-diagonal terms stop shrinking */
+        if(n > 2 && off >= prevOff) break;
+        prevOff = off;
+    }
+}
+
+kmOBB3* kmOBB3FromAABB3(kmOBB3* pOut, const kmAABB3* aabb) {
+    kmAABB3Centre(aabb, &pOut->centre);
+
+    kmVec3Assign(&pOut->axes[0], &KM_VEC3_POS_X);
+    kmVec3Assign(&pOut->axes[1], &KM_VEC3_POS_Y);
+    kmVec3Assign(&pOut->axes[2], &KM_VEC3_POS_Z);
+
+    kmVec3Subtract(&pOut->halfExtents, &aabb->max, &aabb->min);
+    kmVec3Scale(&pOut->halfExtents, &pOut->halfExtents, 0.5f);
+
+    return pOut;
+}
+
+kmOBB3* kmOBB3FromPoints(kmOBB3* pOut, const kmVec3* points, size_t stride, size_t count) {
+    kmMat3 cov, eigen;
+    kmVec3 mean, minP, maxP, local;
+    kmScalar invCount;
+    kmScalar xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+    size_t i;
+    int k;
+
+    if(!count) {
+        kmAABB3 empty;
+        kmVec3Zero(&empty.min);
+        kmVec3Zero(&empty.max);
+        return kmOBB3FromAABB3(pOut, &empty);
+    }
+
+    if(!stride) stride = sizeof(kmVec3);
+
+    invCount = 1.0f / (kmScalar) count;
+
+    kmVec3Zero(&mean);
+    for(i = 0; i < count; ++i) {
+        kmVec3Add(&mean, &mean, KM_STRIDED_AT(kmVec3, points, stride, i));
+    }
+    kmVec3Scale(&mean, &mean, invCount);
+
+    for(i = 0; i < count; ++i) {
+        kmVec3 d;
+        kmVec3Subtract(&d, KM_STRIDED_AT(kmVec3, points, stride, i), &mean);
+        xx += d.x * d.x;
+        xy += d.x * d.y;
+        xz += d.x * d.z;
+        yy += d.y * d.y;
+        yz += d.y * d.z;
+        zz += d.z * d.z;
+    }
+
+    KM_MAT3(&cov, 0, 0) = xx * invCount;
+    KM_MAT3(&cov, 1, 1) = yy * invCount;
+    KM_MAT3(&cov, 2, 2) = zz * invCount;
+    KM_MAT3(&cov, 0, 1) = KM_MAT3(&cov, 1, 0) = xy * invCount;
+    KM_MAT3(&cov, 0, 2) = KM_MAT3(&cov, 2, 0) = xz * invCount;
+    KM_MAT3(&cov, 1, 2) = KM_MAT3(&cov, 2, 1) = yz * invCount;
+
+    kmMat3SymmetricEigen(&cov, &eigen);
+
+    for(k = 0; k < 3; ++k) {
+        kmVec3Fill(&pOut->axes[k], KM_MAT3(&eigen, 0, k), KM_MAT3(&eigen, 1, k), KM_MAT3(&eigen, 2, k));
+    }
+
+    /* Keep the basis orthonormal and right handed */
+    kmVec3Normalize(&pOut->axes[0], &pOut->axes[0]);
+    kmVec3Cross(&pOut->axes[2], &pOut->axes[0], &pOut->axes[1]);
+    kmVec3Normalize(&pOut->axes[2], &pOut->axes[2]);
+    kmVec3Cross(&pOut->axes[1], &pOut->axes[2], &pOut->axes[0]);
+
+    kmVec3Fill(&minP, FLT_MAX, FLT_MAX, FLT_MAX);
+    kmVec3Fill(&maxP, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    for(i = 0; i < count; ++i) {
+        const kmVec3* p = KM_STRIDED_AT(kmVec3, points, stride, i);
+        local.x = kmVec3Dot(p, &pOut->axes[0]);
+        local.y = kmVec3Dot(p, &pOut->axes[1]);
+        local.z = kmVec3Dot(p, &pOut->axes[2]);
+
+        minP.x = kmMin(minP.x, local.x);
+        minP.y = kmMin(minP.y, local.y);
+        minP.z = kmMin(minP.z, local.z);
+        maxP.x = kmMax(maxP.x, local.x);
+        maxP.y = kmMax(maxP.y, local.y);
+        maxP.z = kmMax(maxP.z, local.z);
+    }
+
+    kmVec3Subtract(&pOut->halfExtents, &maxP, &minP);
+    kmVec3Scale(&pOut->halfExtents, &pOut->halfExtents, 0.5f);
+
+    kmVec3Add(&local, &minP, &maxP);
+    kmVec3Scale(&local, &local, 0.5f);
+
+    pOut->centre.x = pOut->axes[0].x * local.x + pOut->axes[1].x * local.y + pOut->axes[2].x * local.z;
+    pOut->centre.y = pOut->axes[0].y * local.x + pOut->axes[1].y * local.y + pOut->axes[2].y * local.z;
+    pOut->centre.z = pOut->axes[0].z * local.x + pOut->axes[1].z * local.y + pOut->axes[2].z * local.z;
+
+    return pOut;
+}
+
+/* Half the extent along axis of the parallelepiped spanned by edges */
+static kmScalar kmOBB3ProjectEdges(const kmVec3 edges[3], const kmVec3* axis) {
+    return fabsf(kmVec3Dot(&edges[0], axis)) +
+           fabsf(kmVec3Dot(&edges[1], axis)) +
+           fabsf(kmVec3Dot(&edges[2], axis));
+}
+
+kmOBB3* kmOBB3Transform(kmOBB3* pOut, const kmOBB3* pIn, const kmMat4* pM) {
+    kmOBB3 result;
+    kmVec3 edges[3];
+    int k;
+
+    kmVec3MultiplyMat4(&result.centre, &pIn->centre, pM);
+
+    for(k = 0; k < 3; ++k) {
+        kmVec3TransformNormal(&edges[k], &pIn->axes[k], pM);
+    }
+
+    /*
+     * Shears and non-uniform scales leave the transformed edges skewed,
+     * so rebuild an orthonormal basis from them and refit the extents
+     * around the parallelepiped they span.
+     */
+    kmVec3Normalize(&result.axes[0], &edges[0]);
+    kmVec3Scale(&result.axes[1], &result.axes[0], kmVec3Dot(&edges[1], &result.axes[0]));
+    kmVec3Subtract(&result.axes[1], &edges[1], &result.axes[1]);
+    kmVec3Normalize(&result.axes[1], &result.axes[1]);
+    kmVec3Cross(&result.axes[2], &result.axes[0], &result.axes[1]);
+
+    kmVec3Scale(&edges[0], &edges[0], pIn->halfExtents.x);
+    kmVec3Scale(&edges[1], &edges[1], pIn->halfExtents.y);
+    kmVec3Scale(&edges[2], &edges[2], pIn->halfExtents.z);
+
+    kmVec3Fill(&result.halfExtents,
+               kmOBB3ProjectEdges(edges, &result.axes[0]),
+               kmOBB3ProjectEdges(edges, &result.axes[1]),
+               kmOBB3ProjectEdges(edges, &result.axes[2]));
+
+    *pOut = result;
+    return pOut;
+}
+
+kmAABB3* kmOBB3ToAABB3(kmAABB3* pOut, const kmOBB3* obb) {
+    const kmVec3* a = obb->axes;
+    const kmVec3* e = &obb->halfExtents;
+
+    kmScalar rx = fabsf(a[0].x) * e->x + fabsf(a[1].x) * e->y + fabsf(a[2].x) * e->z;
+    kmScalar ry = fabsf(a[0].y) * e->x + fabsf(a[1].y) * e->y + fabsf(a[2].y) * e->z;
+    kmScalar rz = fabsf(a[0].z) * e->x + fabsf(a[1].z) * e->y + fabsf(a[2].z) * e->z;
+
+    kmVec3Fill(&pOut->min, obb->centre.x - rx, obb->centre.y - ry, obb->centre.z - rz);
+    kmVec3Fill(&pOut->max, obb->centre.x + rx, obb->centre.y + ry, obb->centre.z + rz);
+
+    return pOut;
+}
+
+kmBool kmOBB3ContainsPoint(const kmOBB3* obb, const kmVec3* point) {
+    kmVec3 d;
+    kmVec3Subtract(&d, point, &obb->centre);
+
+    return fabsf(kmVec3Dot(&d, &obb->axes[0])) <= obb->halfExtents.x &&
+           fabsf(kmVec3Dot(&d, &obb->axes[1])) <= obb->halfExtents.y &&
+           fabsf(kmVec3Dot(&d, &obb->axes[2])) <= obb->halfExtents.z;
+}
+
+kmBool kmOBB3IntersectsOBB3(const kmOBB3* a, const kmOBB3* b) {
+    /* Adapted from Ericson, Real-Time Collision Detection, 4.4.1 */
+    kmScalar R[3][3], AbsR[3][3], t[3];
+    kmScalar ra, rb;
+    kmVec3 d;
+    int i, j;
+
+    /* Rotation expressing b in a's frame */
+    for(i = 0; i < 3; ++i) {
+        for(j = 0; j < 3; ++j) {
+            R[i][j] = kmVec3Dot(&a->axes[i], &b->axes[j]);
+            /* Epsilon keeps near-parallel edges from producing a
+             * degenerate cross product axis */
+            AbsR[i][j] = fabsf(R[i][j]) + kmEpsilon;
+        }
+    }
+
+    kmVec3Subtract(&d, &b->centre, &a->centre);
+    t[0] = kmVec3Dot(&d, &a->axes[0]);
+    t[1] = kmVec3Dot(&d, &a->axes[1]);
+    t[2] = kmVec3Dot(&d, &a->axes[2]);
+
+    /* Face axes of a */
+    for(i = 0; i < 3; ++i) {
+        ra = kmOBB3Extent(a, i);
+        rb = b->halfExtents.x * AbsR[i][0] + b->halfExtents.y * AbsR[i][1] + b->halfExtents.z * AbsR[i][2];
+        if(fabsf(t[i]) > ra + rb) return KM_FALSE;
+    }
+
+    /* Face axes of b */
+    for(j = 0; j < 3; ++j) {
+        ra = a->halfExtents.x * AbsR[0][j] + a->halfExtents.y * AbsR[1][j] + a->halfExtents.z * AbsR[2][j];
+        rb = kmOBB3Extent(b, j);
+        if(fabsf(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > ra + rb) return KM_FALSE;
+    }
+
+    /* Cross products of each pair of edges */
+    for(i = 0; i < 3; ++i) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        for(j = 0; j < 3; ++j) {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            ra = kmOBB3Extent(a, i1) * AbsR[i2][j] + kmOBB3Extent(a, i2) * AbsR[i1][j];
+            rb = kmOBB3Extent(b, j1) * AbsR[i][j2] + kmOBB3Extent(b, j2) * AbsR[i][j1];
+            if(fabsf(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb) return KM_FALSE;
+        }
+    }
+
+    return KM_TRUE;
+}
+
+kmBool kmOBB3IntersectsAABB3(const kmOBB3* obb, const kmAABB3* aabb) {
+    kmOBB3 box;
+    kmOBB3FromAABB3(&box, aabb);
+    return kmOBB3IntersectsOBB3(obb, &box);
+}
+
+/* Half the length of the box's projection onto the plane normal */
+static kmScalar kmOBB3ProjectedRadius(const kmOBB3* obb, const kmPlane* plane) {
+    return obb->halfExtents.x * fabsf(kmPlaneDotNormal(plane, &obb->axes[0])) +
+           obb->halfExtents.y * fabsf(kmPlaneDotNormal(plane, &obb->axes[1])) +
+           obb->halfExtents.z * fabsf(kmPlaneDotNormal(plane, &obb->axes[2]));
+}
+
+KM_POINT_CLASSIFICATION kmOBB3ClassifyPlane(const kmOBB3* obb, const kmPlane* plane) {
+    kmScalar r = kmOBB3ProjectedRadius(obb, plane);
+    kmScalar distance = kmPlaneDotCoord(plane, &obb->centre);
+
+    if(distance > r) return POINT_INFRONT_OF_PLANE;
+    if(distance < -r) return POINT_BEHIND_PLANE;
+
+    return POINT_ON_PLANE;
+}
+
+kmEnum kmOBB3IntersectsFrustum(const kmOBB3* obb, const kmPlane* planes) {
+    kmEnum result = KM_CONTAINS_ALL;
+    int i;
+
+    for(i = 0; i < 6; ++i) {
+        kmScalar r = kmOBB3ProjectedRadius(obb, &planes[i]);
+        kmScalar distance = kmPlaneDotCoord(&planes[i], &obb->centre);
+
+        if(distance < -r) {
+            return KM_CONTAINS_NONE;
+        }
+
+        if(distance < r) {
+            result = KM_CONTAINS_PARTIAL;
+        }
+    }
+
+    return result;
+}
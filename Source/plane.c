@@ -132,7 +132,7 @@ kmVec3* kmPlaneIntersectLine(kmVec3* pOut, const kmPlane* pP, const kmVec3* pV1,
     nt = -(n.x * pV1->x + n.y * pV1->y + n.z * pV1->z + pP->d);
     dt = (n.x * d.x + n.y * d.y + n.z * d.z);
     
-    if (fabs(dt) < kmEpsilon) {
+    if (fabsf(dt) < kmEpsilon) {
         pOut = NULL;
         return pOut; /* line parallel or contained*/
     }
@@ -210,7 +210,7 @@ kmPlane* kmPlaneExtractFromMat4(kmPlane* pOut, const struct kmMat4* pIn, kmInt r
 kmVec3* kmPlaneGetIntersection(kmVec3* pOut, const kmPlane* p1, const kmPlane* p2, const kmPlane* p3) {
     kmVec3 n1, n2, n3, cross;
     kmVec3 r1, r2, r3;
-    double denom = 0;
+    kmScalar denom = 0.0f;
     
     kmVec3Fill(&n1, p1->a, p1->b, p1->c);
     kmVec3Fill(&n2, p2->a, p2->b, p2->c);
@@ -220,7 +220,7 @@ kmVec3* kmPlaneGetIntersection(kmVec3* pOut, const kmPlane* p1, const kmPlane* p
 
     denom = kmVec3Dot(&n1, &cross);
 
-    if (kmAlmostEqual(denom, 0.0)) {
+    if (kmAlmostEqual(denom, 0.0f)) {
         return NULL;
     }
 
@@ -234,7 +234,7 @@ kmVec3* kmPlaneGetIntersection(kmVec3* pOut, const kmPlane* p1, const kmPlane* p
 
     kmVec3Subtract(pOut, &r1, &r2);
     kmVec3Subtract(pOut, pOut, &r3);
-    kmVec3Scale(pOut, pOut, 1.0 / denom);
+    kmVec3Scale(pOut, pOut, 1.0f / denom);
 
     /*p = -d1 * ( n2.Cross ( n3 ) ) – d2 * ( n3.Cross ( n1 ) ) – d3 * ( n1.Cross ( n2 ) ) / denom;*/
 
@@ -0,0 +1,239 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+
+#include <kazmath/quantize.h>
+
+/* Largest magnitude of any but the largest component of a unit quaternion */
+#define KM_SMALLEST_THREE_RANGE 0.707106781186547524f
+
+static inline uint32_t kmScalarBits(kmScalar s) {
+    uint32_t u;
+    memcpy(&u, &s, sizeof(u));
+    return u;
+}
+
+static inline kmScalar kmBitsScalar(uint32_t u) {
+    kmScalar s;
+    memcpy(&s, &u, sizeof(s));
+    return s;
+}
+
+kmHalf kmHalfFromScalar(kmScalar s) {
+    const uint32_t infinity = 255u << 23;
+    const uint32_t halfMax = (127u + 16u) << 23;
+    const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t u = kmScalarBits(s);
+    uint32_t sign = u & 0x80000000u;
+    uint32_t result;
+
+    u ^= sign;
+
+    if(u >= halfMax) {
+        /* Overflow to infinity, NaN stays a (quiet) NaN */
+        result = (u > infinity) ? 0x7e00u : 0x7c00u;
+    } else if(u < (113u << 23)) {
+        /* Subnormal, let the float adder do the rounding */
+        result = kmScalarBits(kmBitsScalar(u) + kmBitsScalar(denormMagic)) - denormMagic;
+    } else {
+        uint32_t odd = (u >> 13) & 1u;
+        u += ((uint32_t) (15 - 127) << 23) + 0xfffu;
+        u += odd;
+        result = u >> 13;
+    }
+
+    return (kmHalf) (result | (sign >> 16));
+}
+
+kmScalar kmHalfToScalar(kmHalf h) {
+    const uint32_t exponentMask = 0x7c00u << 13;
+    uint32_t u = ((uint32_t) h & 0x7fffu) << 13;
+    uint32_t exponent = u & exponentMask;
+
+    u += (127u - 15u) << 23;
+
+    if(exponent == exponentMask) {
+        /* Infinity or NaN */
+        u += (128u - 16u) << 23;
+    } else if(exponent == 0) {
+        /* Zero or subnormal, renormalize */
+        u += 1u << 23;
+        u = kmScalarBits(kmBitsScalar(u) - kmBitsScalar(113u << 23));
+    }
+
+    return kmBitsScalar(u | (((uint32_t) h & 0x8000u) << 16));
+}
+
+void kmHalfFromScalarArray(kmHalf* pOut, const kmScalar* in, size_t count) {
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        pOut[i] = kmHalfFromScalar(in[i]);
+    }
+}
+
+void kmHalfToScalarArray(kmScalar* pOut, const kmHalf* in, size_t count) {
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        pOut[i] = kmHalfToScalar(in[i]);
+    }
+}
+
+/*
+ * Finds the largest component of q and returns the other three, negated
+ * if needed so that the dropped one is positive.
+ */
+static unsigned kmSmallestThree(const kmQuaternion* q, kmScalar out[3]) {
+    const kmScalar c[4] = { q->x, q->y, q->z, q->w };
+    unsigned largest = 0, i, j = 0;
+    kmScalar sign;
+
+    for(i = 1; i < 4; ++i) {
+        if(fabsf(c[i]) > fabsf(c[largest])) {
+            largest = i;
+        }
+    }
+
+    sign = (c[largest] < 0.0f) ? -1.0f : 1.0f;
+
+    for(i = 0; i < 4; ++i) {
+        if(i != largest) {
+            out[j++] = c[i] * sign;
+        }
+    }
+
+    return largest;
+}
+
+static inline uint32_t kmQuantizeComponent(kmScalar c, uint32_t maxValue) {
+    kmScalar n = (c + KM_SMALLEST_THREE_RANGE) * (0.5f / KM_SMALLEST_THREE_RANGE);
+    return (uint32_t) (kmClamp(n, 0.0f, 1.0f) * (kmScalar) maxValue + 0.5f);
+}
+
+/*
+ * Rebuilds a quaternion from the index of the dropped component and the
+ * other three, already scaled back into range.
+ */
+static inline kmQuaternion* kmSmallestThreeRestore(kmQuaternion* pOut, unsigned largest,
+                                                   kmScalar a, kmScalar b, kmScalar c) {
+    kmScalar d = sqrtf(kmMax(0.0f, 1.0f - a * a - b * b - c * c));
+
+    switch(largest) {
+        case 0: pOut->x = d; pOut->y = a; pOut->z = b; pOut->w = c; break;
+        case 1: pOut->x = a; pOut->y = d; pOut->z = b; pOut->w = c; break;
+        case 2: pOut->x = a; pOut->y = b; pOut->z = d; pOut->w = c; break;
+        default: pOut->x = a; pOut->y = b; pOut->z = c; pOut->w = d; break;
+    }
+
+    return pOut;
+}
+
+void kmQuaternionPack48(uint16_t pOut[3], const kmQuaternion* pIn) {
+    kmScalar c[3];
+    unsigned largest = kmSmallestThree(pIn, c);
+
+    /* The two bit index lives in the top bits of the first two words */
+    pOut[0] = (uint16_t) (((largest >> 1) << 15) | kmQuantizeComponent(c[0], 0x7fffu));
+    pOut[1] = (uint16_t) (((largest & 1u) << 15) | kmQuantizeComponent(c[1], 0x7fffu));
+    pOut[2] = (uint16_t) kmQuantizeComponent(c[2], 0x7fffu);
+}
+
+kmQuaternion* kmQuaternionUnpack48(kmQuaternion* pOut, const uint16_t pIn[3]) {
+    const kmScalar scale = 2.0f * KM_SMALLEST_THREE_RANGE / 32767.0f;
+    unsigned largest = ((pIn[0] >> 15) << 1) | (pIn[1] >> 15);
+
+    return kmSmallestThreeRestore(pOut, largest,
+                                  (kmScalar) (pIn[0] & 0x7fffu) * scale - KM_SMALLEST_THREE_RANGE,
+                                  (kmScalar) (pIn[1] & 0x7fffu) * scale - KM_SMALLEST_THREE_RANGE,
+                                  (kmScalar) (pIn[2] & 0x7fffu) * scale - KM_SMALLEST_THREE_RANGE);
+}
+
+uint32_t kmQuaternionPack32(const kmQuaternion* pIn) {
+    kmScalar c[3];
+    uint32_t largest = kmSmallestThree(pIn, c);
+
+    return (largest << 30) |
+           (kmQuantizeComponent(c[0], 0x3ffu) << 20) |
+           (kmQuantizeComponent(c[1], 0x3ffu) << 10) |
+           kmQuantizeComponent(c[2], 0x3ffu);
+}
+
+kmQuaternion* kmQuaternionUnpack32(kmQuaternion* pOut, uint32_t packed) {
+    const kmScalar scale = 2.0f * KM_SMALLEST_THREE_RANGE / 1023.0f;
+
+    return kmSmallestThreeRestore(pOut, packed >> 30,
+                                  (kmScalar) ((packed >> 20) & 0x3ffu) * scale - KM_SMALLEST_THREE_RANGE,
+                                  (kmScalar) ((packed >> 10) & 0x3ffu) * scale - KM_SMALLEST_THREE_RANGE,
+                                  (kmScalar) (packed & 0x3ffu) * scale - KM_SMALLEST_THREE_RANGE);
+}
+
+void kmQuaternionUnpack48Array(kmQuaternion* pOut, const uint16_t* pIn, size_t count) {
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmQuaternionUnpack48(&pOut[i], &pIn[i * 3]);
+    }
+}
+
+void kmQuaternionUnpack32Array(kmQuaternion* pOut, const uint32_t* pIn, size_t count) {
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmQuaternionUnpack32(&pOut[i], pIn[i]);
+    }
+}
+
+static inline uint16_t kmQuantize16(kmScalar v, kmScalar min, kmScalar max) {
+    kmScalar extent = max - min;
+    kmScalar n = (extent > 0.0f) ? (v - min) / extent : 0.0f;
+    return (uint16_t) (kmClamp(n, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+void kmVec3Quantize16(uint16_t pOut[3], const kmVec3* pIn, const kmAABB3* range) {
+    pOut[0] = kmQuantize16(pIn->x, range->min.x, range->max.x);
+    pOut[1] = kmQuantize16(pIn->y, range->min.y, range->max.y);
+    pOut[2] = kmQuantize16(pIn->z, range->min.z, range->max.z);
+}
+
+kmVec3* kmVec3Dequantize16(kmVec3* pOut, const uint16_t pIn[3], const kmAABB3* range) {
+    kmVec3Dequantize16Array(pOut, pIn, range, 1);
+    return pOut;
+}
+
+void kmVec3Dequantize16Array(kmVec3* pOut, const uint16_t* pIn, const kmAABB3* range, size_t count) {
+    const kmScalar sx = (range->max.x - range->min.x) / 65535.0f;
+    const kmScalar sy = (range->max.y - range->min.y) / 65535.0f;
+    const kmScalar sz = (range->max.z - range->min.z) / 65535.0f;
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        pOut[i].x = range->min.x + (kmScalar) pIn[i * 3 + 0] * sx;
+        pOut[i].y = range->min.y + (kmScalar) pIn[i * 3 + 1] * sy;
+        pOut[i].z = range->min.z + (kmScalar) pIn[i * 3 + 2] * sz;
+    }
+}
@@ -34,6 +34,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <kazmath/vec3.h>
 #include <kazmath/quaternion.h>
 
+#include "stride.h"
+
 int kmQuaternionAreEqual(const kmQuaternion* p1, const kmQuaternion* p2) {
     if((!kmAlmostEqual(p1->x, p2->x)) || (!kmAlmostEqual(p1->y, p2->y)) || (!kmAlmostEqual(p1->z, p2->z)) || (!kmAlmostEqual(p1->w, p2->w))) {
         return KM_FALSE;
@@ -62,9 +64,12 @@ kmScalar kmQuaternionDot(const kmQuaternion* q1, const kmQuaternion* q2)
 
 kmQuaternion* kmQuaternionExp(kmQuaternion* pOut, const kmQuaternion* pIn)
 {
-	assert(0);
+	kmScalar theta = sqrtf(pIn->x * pIn->x + pIn->y * pIn->y + pIn->z * pIn->z);
+	kmScalar scale = expf(pIn->w);
+	kmScalar s = (theta > kmEpsilon) ? sinf(theta) / theta : 1.0f;
 
-	return pOut;
+	return kmQuaternionFill(pOut, pIn->x * s * scale, pIn->y * s * scale,
+	                        pIn->z * s * scale, cosf(theta) * scale);
 }
 
 kmQuaternion* kmQuaternionIdentity(kmQuaternion* pOut)
@@ -82,7 +87,7 @@ kmQuaternion* kmQuaternionInverse(kmQuaternion* pOut,
 {
 	kmScalar l = kmQuaternionLength(pIn);
 
-	if (fabs(l) < kmEpsilon)
+	if (fabsf(l) < kmEpsilon)
 	{
 		pOut->x = 0.0;
 		pOut->y = 0.0;
@@ -102,13 +107,13 @@ kmQuaternion* kmQuaternionInverse(kmQuaternion* pOut,
 
 int kmQuaternionIsIdentity(const kmQuaternion* pIn)
 {
-	return (pIn->x == 0.0 && pIn->y == 0.0 && pIn->z == 0.0 &&
-				pIn->w == 1.0);
+	return (pIn->x == 0.0f && pIn->y == 0.0f && pIn->z == 0.0f &&
+				pIn->w == 1.0f);
 }
 
 kmScalar kmQuaternionLength(const kmQuaternion* pIn)
 {
-    return sqrt(kmQuaternionLengthSq(pIn));
+    return sqrtf(kmQuaternionLengthSq(pIn));
 }
 
 kmScalar kmQuaternionLengthSq(const kmQuaternion* pIn)
@@ -125,9 +130,12 @@ kmQuaternion* kmQuaternionLn(kmQuaternion* pOut,
 		The natural logarithm of Q is, ln(Q) = (0, theta * v)
 	*/
 
-	assert(0);
+	kmScalar sinTheta = sqrtf(pIn->x * pIn->x + pIn->y * pIn->y + pIn->z * pIn->z);
+	kmScalar length = sqrtf(sinTheta * sinTheta + pIn->w * pIn->w);
+	kmScalar theta = atan2f(sinTheta, pIn->w);
+	kmScalar s = (sinTheta > kmEpsilon) ? theta / sinTheta : 1.0f / length;
 
-	return pOut;
+	return kmQuaternionFill(pOut, pIn->x * s, pIn->y * s, pIn->z * s, logf(length));
 }
 
 kmQuaternion* kmQuaternionMultiply(kmQuaternion* pOut,
@@ -157,7 +165,7 @@ kmQuaternion* kmQuaternionNormalize(kmQuaternion* pOut,
 {
 	kmScalar length = kmQuaternionLength(pIn);
 
-    if (fabs(length) < kmEpsilon)
+    if (fabsf(length) < kmEpsilon)
     {
         pOut->x = 0.0;
         pOut->y = 0.0;
@@ -257,7 +265,7 @@ taken from the Matrix and Quaternion FAQ
 
 	if(diagonal > kmEpsilon) {
 		/* Calculate the scale of the diagonal*/
-		scale = (kmScalar)sqrt(diagonal ) * 2;
+		scale = sqrtf(diagonal) * 2.0f;
 
 		/* Calculate the x, y, x and w of the quaternion through the respective equation*/
 		x = ( pMatrix[9] - pMatrix[6] ) / scale;
@@ -271,7 +279,7 @@ taken from the Matrix and Quaternion FAQ
 		if ( pMatrix[0] > pMatrix[5] && pMatrix[0] > pMatrix[10] )
 		{
 			/* Find the scale according to the first element, and double that value*/
-			scale = (kmScalar)sqrt( 1.0f + pMatrix[0] - pMatrix[5] - pMatrix[10] ) * 2.0f;
+			scale = sqrtf( 1.0f + pMatrix[0] - pMatrix[5] - pMatrix[10] ) * 2.0f;
 
 			/* Calculate the x, y, x and w of the quaternion through the respective equation*/
 			x = 0.25f * scale;
@@ -283,7 +291,7 @@ taken from the Matrix and Quaternion FAQ
 		else if (pMatrix[5] > pMatrix[10])
 		{
 			/* Find the scale according to the second element, and double that value*/
-			scale = (kmScalar)sqrt( 1.0f + pMatrix[5] - pMatrix[0] - pMatrix[10] ) * 2.0f;
+			scale = sqrtf( 1.0f + pMatrix[5] - pMatrix[0] - pMatrix[10] ) * 2.0f;
 
 			/* Calculate the x, y, x and w of the quaternion through the respective equation*/
 			x = (pMatrix[4] + pMatrix[1] ) / scale;
@@ -295,7 +303,7 @@ taken from the Matrix and Quaternion FAQ
 		else
 		{
 			/* Find the scale according to the third element, and double that value*/
-			scale  = (kmScalar)sqrt( 1.0f + pMatrix[10] - pMatrix[0] - pMatrix[5] ) * 2.0f;
+			scale  = sqrtf( 1.0f + pMatrix[10] - pMatrix[0] - pMatrix[5] ) * 2.0f;
 
 			/* Calculate the x, y, x and w of the quaternion through the respective equation*/
 			x = (pMatrix[2] + pMatrix[8] ) / scale;
@@ -329,12 +337,12 @@ kmQuaternion* kmQuaternionRotationPitchYawRoll(kmQuaternion* pOut,
     assert(roll <= 2*kmPI);
 
     /* Finds the Sin and Cosin for each half angles.*/
-    sY = sinf(yaw * 0.5);
-    cY = cosf(yaw * 0.5);
-    sZ = sinf(roll * 0.5);
-    cZ = cosf(roll * 0.5);
-    sX = sinf(pitch * 0.5);
-    cX = cosf(pitch * 0.5);
+    sY = sinf(yaw * 0.5f);
+    cY = cosf(yaw * 0.5f);
+    sZ = sinf(roll * 0.5f);
+    cZ = cosf(roll * 0.5f);
+    sX = sinf(pitch * 0.5f);
+    cX = cosf(pitch * 0.5f);
 
     /* Formula to construct a new Quaternion based on Euler Angles.*/
     pOut->w = cY * cZ * cX - sY * sZ * sX;
@@ -357,7 +365,7 @@ kmQuaternion* kmQuaternionSlerp(kmQuaternion* pOut,
     kmScalar theta;
 
     kmScalar dot = kmQuaternionDot(q1, q2);
-    const double DOT_THRESHOLD = 0.9995;
+    const kmScalar DOT_THRESHOLD = 0.9995f;
 
     if (dot > DOT_THRESHOLD) {
         kmQuaternion diff;
@@ -369,36 +377,296 @@ kmQuaternion* kmQuaternionSlerp(kmQuaternion* pOut,
         return pOut;
     }
 
-    dot = kmClamp(dot, -1, 1);
+    dot = kmClamp(dot, -1.0f, 1.0f);
 
-    theta_0 = acos(dot);
+    theta_0 = acosf(dot);
     theta = theta_0 * t;
 
     kmQuaternionScale(&tmp, q1, dot);
     kmQuaternionSubtract(&tmp, q2, &tmp);
     kmQuaternionNormalize(&tmp, &tmp);
 
-    kmQuaternionScale(&t1, q1, cos(theta));
-    kmQuaternionScale(&t2, &tmp, sin(theta));
+    kmQuaternionScale(&t1, q1, cosf(theta));
+    kmQuaternionScale(&t2, &tmp, sinf(theta));
 
     kmQuaternionAdd(pOut, &t1, &t2);
 
 	return pOut;
 }
 
+void kmQuaternionSlerpArray(const kmQuaternionSoA* pOut, const kmQuaternionSoA* q1,
+                            const kmQuaternionSoA* q2, const kmScalar* t,
+                            kmScalar uniformT, size_t count)
+{
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmScalar ti = t ? t[i] : uniformT;
+        kmScalar ax = q1->x[i], ay = q1->y[i], az = q1->z[i], aw = q1->w[i];
+        kmScalar bx = q2->x[i], by = q2->y[i], bz = q2->z[i], bw = q2->w[i];
+
+        kmScalar dot = ax * bx + ay * by + az * bz + aw * bw;
+        kmScalar sign = dot < 0.0f ? -1.0f : 1.0f;
+        kmScalar cosTheta = kmMin(dot * sign, 1.0f);
+
+        /* Nearly parallel pairs fall back to a normalized lerp */
+        kmBool linear = cosTheta > 0.9995f;
+        kmScalar theta = acosf(cosTheta);
+        kmScalar invSin = linear ? 1.0f : 1.0f / sinf(theta);
+        kmScalar w1 = linear ? 1.0f - ti : sinf((1.0f - ti) * theta) * invSin;
+        kmScalar w2 = (linear ? ti : sinf(ti * theta) * invSin) * sign;
+
+        kmScalar x = w1 * ax + w2 * bx;
+        kmScalar y = w1 * ay + w2 * by;
+        kmScalar z = w1 * az + w2 * bz;
+        kmScalar w = w1 * aw + w2 * bw;
+        kmScalar scale = linear ? 1.0f / sqrtf(x * x + y * y + z * z + w * w) : 1.0f;
+
+        pOut->x[i] = x * scale;
+        pOut->y[i] = y * scale;
+        pOut->z[i] = z * scale;
+        pOut->w[i] = w * scale;
+    }
+}
+
+void kmQuaternionNlerpArray(const kmQuaternionSoA* pOut, const kmQuaternionSoA* q1,
+                            const kmQuaternionSoA* q2, const kmScalar* t,
+                            kmScalar uniformT, size_t count)
+{
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmScalar ti = t ? t[i] : uniformT;
+        kmScalar ax = q1->x[i], ay = q1->y[i], az = q1->z[i], aw = q1->w[i];
+        kmScalar bx = q2->x[i], by = q2->y[i], bz = q2->z[i], bw = q2->w[i];
+
+        kmScalar dot = ax * bx + ay * by + az * bz + aw * bw;
+        kmScalar w1 = 1.0f - ti;
+        kmScalar w2 = dot < 0.0f ? -ti : ti;
+
+        kmScalar x = w1 * ax + w2 * bx;
+        kmScalar y = w1 * ay + w2 * by;
+        kmScalar z = w1 * az + w2 * bz;
+        kmScalar w = w1 * aw + w2 * bw;
+        kmScalar scale = 1.0f / sqrtf(x * x + y * y + z * z + w * w);
+
+        pOut->x[i] = x * scale;
+        pOut->y[i] = y * scale;
+        pOut->z[i] = z * scale;
+        pOut->w[i] = w * scale;
+    }
+}
+
+/*
+ * Coefficients of Eberly's slerp expansion. The last term is scaled by
+ * 1 + mu to absorb the truncation error of the series.
+ */
+#define SLERP_FAST_MU 1.90110745351730037f
+
+static const kmScalar kmSlerpFastU[8] = {
+    1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9),
+    1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), SLERP_FAST_MU / (8 * 17)
+};
+
+static const kmScalar kmSlerpFastV[8] = {
+    1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9,
+    5.0f / 11, 6.0f / 13, 7.0f / 15, SLERP_FAST_MU * 8 / 17
+};
+
+/* Approximates sin(t * theta) / sin(theta) given cos(theta) - 1 */
+static kmScalar kmSlerpFastWeight(kmScalar t, kmScalar xm1)
+{
+    kmScalar sqrT = t * t;
+    kmScalar result = 1.0f;
+    int i;
+
+    for(i = 7; i >= 0; --i) {
+        result = 1.0f + (kmSlerpFastU[i] * sqrT - kmSlerpFastV[i]) * xm1 * result;
+    }
+
+    return t * result;
+}
+
+kmQuaternion* kmQuaternionSlerpFast(kmQuaternion* pOut, const kmQuaternion* q1,
+                                    const kmQuaternion* q2, kmScalar t)
+{
+    kmScalar dot = kmQuaternionDot(q1, q2);
+    kmScalar sign = dot < 0.0f ? -1.0f : 1.0f;
+    kmScalar xm1 = dot * sign - 1.0f;
+    kmScalar w1 = kmSlerpFastWeight(1.0f - t, xm1);
+    kmScalar w2 = kmSlerpFastWeight(t, xm1) * sign;
+
+    return kmQuaternionFill(pOut,
+        w1 * q1->x + w2 * q2->x,
+        w1 * q1->y + w2 * q2->y,
+        w1 * q1->z + w2 * q2->z,
+        w1 * q1->w + w2 * q2->w
+    );
+}
+
+void kmQuaternionSlerpFastArray(const kmQuaternionSoA* pOut, const kmQuaternionSoA* q1,
+                                const kmQuaternionSoA* q2, const kmScalar* t,
+                                kmScalar uniformT, size_t count)
+{
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmScalar ti = t ? t[i] : uniformT;
+        kmScalar ax = q1->x[i], ay = q1->y[i], az = q1->z[i], aw = q1->w[i];
+        kmScalar bx = q2->x[i], by = q2->y[i], bz = q2->z[i], bw = q2->w[i];
+
+        kmScalar dot = ax * bx + ay * by + az * bz + aw * bw;
+        kmScalar sign = dot < 0.0f ? -1.0f : 1.0f;
+        kmScalar xm1 = dot * sign - 1.0f;
+        kmScalar w1 = kmSlerpFastWeight(1.0f - ti, xm1);
+        kmScalar w2 = kmSlerpFastWeight(ti, xm1) * sign;
+
+        pOut->x[i] = w1 * ax + w2 * bx;
+        pOut->y[i] = w1 * ay + w2 * by;
+        pOut->z[i] = w1 * az + w2 * bz;
+        pOut->w[i] = w1 * aw + w2 * bw;
+    }
+}
+
+kmQuaternion* kmQuaternionSquadTangent(kmQuaternion* pOut, const kmQuaternion* prev,
+                                       const kmQuaternion* q, const kmQuaternion* next)
+{
+	kmQuaternion inverse, p, n, lnPrev, lnNext, sum;
+
+	/* Take the neighbours on q's side so the tangent follows the short arcs */
+	kmQuaternionAssign(&p, prev);
+	if(kmQuaternionDot(q, &p) < 0.0f) {
+		kmQuaternionScale(&p, &p, -1.0f);
+	}
+
+	kmQuaternionAssign(&n, next);
+	if(kmQuaternionDot(q, &n) < 0.0f) {
+		kmQuaternionScale(&n, &n, -1.0f);
+	}
+
+	/* s = q * exp(-(ln(q^-1 * next) + ln(q^-1 * prev)) / 4) */
+	kmQuaternionFill(&inverse, -q->x, -q->y, -q->z, q->w);
+	kmQuaternionMultiply(&p, &inverse, &p);
+	kmQuaternionMultiply(&n, &inverse, &n);
+	kmQuaternionLn(&lnPrev, &p);
+	kmQuaternionLn(&lnNext, &n);
+	kmQuaternionAdd(&sum, &lnPrev, &lnNext);
+	kmQuaternionScale(&sum, &sum, -0.25f);
+	kmQuaternionExp(&sum, &sum);
+
+	return kmQuaternionMultiply(pOut, q, &sum);
+}
+
+void kmQuaternionSquadTangentArray(kmQuaternion* pOut, const kmQuaternion* keys, size_t count)
+{
+	kmQuaternion prev, current;
+	size_t i;
+
+	if(!count) {
+		return;
+	}
+
+	/* Keys are copied before pOut[i] is written so pOut may be keys */
+	kmQuaternionAssign(&prev, &keys[0]);
+
+	for(i = 0; i < count; ++i) {
+		const kmQuaternion* next = &keys[i + 1 < count ? i + 1 : i];
+
+		kmQuaternionAssign(&current, &keys[i]);
+		kmQuaternionSquadTangent(&pOut[i], &prev, &current, next);
+		prev = current;
+	}
+}
+
+/*
+ * Slerps along whichever arc a and b describe, without flipping b, as
+ * squad needs.
+ */
+static inline void kmSquadSlerp(kmScalar out[4], const kmScalar a[4], const kmScalar b[4], kmScalar t)
+{
+	kmScalar dot = kmClamp(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3], -1.0f, 1.0f);
+	kmScalar w1 = 1.0f - t, w2 = t;
+	int i;
+
+	if(fabsf(dot) < 0.9995f) {
+		kmScalar theta = acosf(dot);
+		kmScalar invSin = 1.0f / sinf(theta);
+		w1 = sinf((1.0f - t) * theta) * invSin;
+		w2 = sinf(t * theta) * invSin;
+	}
+
+	for(i = 0; i < 4; ++i) {
+		out[i] = w1 * a[i] + w2 * b[i];
+	}
+}
+
+/* out = slerp(slerp(q1, q2, t), slerp(a, b, t), 2t(1 - t)) */
+static inline void kmSquad(kmScalar out[4], const kmScalar q1[4], const kmScalar q2[4],
+                           const kmScalar a[4], const kmScalar b[4], kmScalar t)
+{
+	kmScalar outer[4], inner[4], invLength;
+	int i;
+
+	kmSquadSlerp(outer, q1, q2, t);
+	kmSquadSlerp(inner, a, b, t);
+	kmSquadSlerp(out, outer, inner, 2.0f * t * (1.0f - t));
+
+	/* The near-parallel fallbacks are linear, renormalize once at the end */
+	invLength = 1.0f / sqrtf(out[0] * out[0] + out[1] * out[1] + out[2] * out[2] + out[3] * out[3]);
+	for(i = 0; i < 4; ++i) {
+		out[i] *= invLength;
+	}
+}
+
+kmQuaternion* kmQuaternionSquad(kmQuaternion* pOut, const kmQuaternion* q1,
+                                const kmQuaternion* q2, const kmQuaternion* a,
+                                const kmQuaternion* b, kmScalar t)
+{
+	const kmScalar k1[4] = { q1->x, q1->y, q1->z, q1->w };
+	const kmScalar k2[4] = { q2->x, q2->y, q2->z, q2->w };
+	const kmScalar ka[4] = { a->x, a->y, a->z, a->w };
+	const kmScalar kb[4] = { b->x, b->y, b->z, b->w };
+	kmScalar out[4];
+
+	kmSquad(out, k1, k2, ka, kb, t);
+	return kmQuaternionFill(pOut, out[0], out[1], out[2], out[3]);
+}
+
+void kmQuaternionSquadArray(const kmQuaternionSoA* pOut, const kmQuaternionSoA* q1,
+                            const kmQuaternionSoA* q2, const kmQuaternionSoA* a,
+                            const kmQuaternionSoA* b, const kmScalar* t,
+                            kmScalar uniformT, size_t count)
+{
+	size_t i;
+
+	for(i = 0; i < count; ++i) {
+		const kmScalar k1[4] = { q1->x[i], q1->y[i], q1->z[i], q1->w[i] };
+		const kmScalar k2[4] = { q2->x[i], q2->y[i], q2->z[i], q2->w[i] };
+		const kmScalar ka[4] = { a->x[i], a->y[i], a->z[i], a->w[i] };
+		const kmScalar kb[4] = { b->x[i], b->y[i], b->z[i], b->w[i] };
+		kmScalar out[4];
+
+		kmSquad(out, k1, k2, ka, kb, t ? t[i] : uniformT);
+		pOut->x[i] = out[0];
+		pOut->y[i] = out[1];
+		pOut->z[i] = out[2];
+		pOut->w[i] = out[3];
+	}
+}
+
 void kmQuaternionToAxisAngle(const kmQuaternion* pIn, kmVec3* pAxis, kmScalar* pAngle)
 {
 	kmScalar	scale;			/* temp vars*/
 	kmQuaternion tmp;
 
-	if(pIn->w > 1.0) {
+	if(pIn->w > 1.0f) {
 		kmQuaternionNormalize(&tmp, pIn);
 	} else {
 		kmQuaternionAssign(&tmp, pIn);
 	}
 
-	*pAngle = 2.0 * acosf(tmp.w);
-	scale = sqrtf(1.0 - kmSQR(tmp.w));
+	*pAngle = 2.0f * acosf(tmp.w);
+	scale = sqrtf(1.0f - kmSQR(tmp.w));
 
 	if (scale < kmEpsilon) {	/* angle is 0 or 360 so just simply set axis to 0,0,1 with angle 0*/
 		pAxis->x = 0.0f;
@@ -465,13 +733,13 @@ kmQuaternion* kmQuaternionRotationBetweenVec3(kmQuaternion* pOut,
 
 	a = kmVec3Dot(&v1, &v2);
 
-	if (a >= 1.0) {
+	if (a >= 1.0f) {
 		kmQuaternionIdentity(pOut);
 		return pOut;
 	}
 
 	if (a < (1e-6f - 1.0f))	{
-		if (fabs(kmVec3LengthSq(fallback)) < kmEpsilon) {
+		if (fabsf(kmVec3LengthSq(fallback)) < kmEpsilon) {
             kmQuaternionRotationAxisAngle(pOut, fallback, kmPI);
 		} else {
 			kmVec3 axis;
@@ -484,7 +752,7 @@ kmQuaternion* kmQuaternionRotationBetweenVec3(kmQuaternion* pOut,
 			kmVec3Cross(&axis, &X, vec1);
 
 			/*If axis is zero*/
-			if (fabs(kmVec3LengthSq(&axis)) < kmEpsilon) {
+			if (fabsf(kmVec3LengthSq(&axis)) < kmEpsilon) {
 				kmVec3 Y;
 				Y.x = 0.0;
 				Y.y = 1.0;
@@ -535,6 +803,50 @@ kmVec3* kmQuaternionMultiplyVec3(kmVec3* pOut, const kmQuaternion* q, const kmVe
 	return pOut;
 }
 
+/* Below this many vectors the matrix setup costs more than it saves */
+#define KM_QUATERNION_MATRIX_BATCH 4
+
+void kmQuaternionMultiplyVec3Array(kmVec3* pOut, size_t outStride, const kmQuaternion* q,
+                                   const kmVec3* pIn, size_t inStride, size_t count) {
+	kmScalar m[9];
+	size_t i;
+
+	if(!outStride) outStride = sizeof(kmVec3);
+	if(!inStride) inStride = sizeof(kmVec3);
+
+	if(count < KM_QUATERNION_MATRIX_BATCH) {
+		for(i = 0; i < count; ++i) {
+			kmVec3 v = *KM_STRIDED_AT(kmVec3, pIn, inStride, i);
+			kmQuaternionMultiplyVec3(KM_STRIDED_OUT(kmVec3, pOut, outStride, i), q, &v);
+		}
+		return;
+	}
+
+	{
+		kmScalar x2 = q->x + q->x, y2 = q->y + q->y, z2 = q->z + q->z;
+		kmScalar xx = q->x * x2, xy = q->x * y2, xz = q->x * z2;
+		kmScalar yy = q->y * y2, yz = q->y * z2, zz = q->z * z2;
+		kmScalar wx = q->w * x2, wy = q->w * y2, wz = q->w * z2;
+
+		/* Column major, like kmMat3 */
+		m[0] = 1.0f - (yy + zz); m[1] = xy + wz; m[2] = xz - wy;
+		m[3] = xy - wz; m[4] = 1.0f - (xx + zz); m[5] = yz + wx;
+		m[6] = xz + wy; m[7] = yz - wx; m[8] = 1.0f - (xx + yy);
+	}
+
+	for(i = 0; i < count; ++i) {
+		const kmVec3* in = KM_STRIDED_AT(kmVec3, pIn, inStride, i);
+		kmVec3* out = KM_STRIDED_OUT(kmVec3, pOut, outStride, i);
+
+		/* Read everything first so that pOut may alias pIn */
+		kmScalar x = in->x, y = in->y, z = in->z;
+
+		out->x = m[0] * x + m[3] * y + m[6] * z;
+		out->y = m[1] * x + m[4] * y + m[7] * z;
+		out->z = m[2] * x + m[5] * y + m[8] * z;
+	}
+}
+
 kmVec3* kmQuaternionGetUpVec3(kmVec3* pOut, const kmQuaternion* pIn) {
     return kmQuaternionMultiplyVec3(pOut, pIn, &KM_VEC3_POS_Y);
 }
@@ -552,17 +864,17 @@ kmVec3* kmQuaternionGetForwardVec3LH(kmVec3* pOut, const kmQuaternion* pIn) {
 }
 
 kmScalar kmQuaternionGetPitch(const kmQuaternion* q) {
-    float result = atan2(2 * (q->y * q->z + q->w * q->x), q->w * q->w - q->x * q->x - q->y * q->y + q->z * q->z);
+    float result = atan2f(2.0f * (q->y * q->z + q->w * q->x), q->w * q->w - q->x * q->x - q->y * q->y + q->z * q->z);
     return result;
 }
 
 kmScalar kmQuaternionGetYaw(const kmQuaternion* q) {
-    float result = asin(-2 * (q->x * q->z - q->w * q->y));
+    float result = asinf(-2.0f * (q->x * q->z - q->w * q->y));
     return result;
 }
 
 kmScalar kmQuaternionGetRoll(const kmQuaternion* q) {
-    float result = atan2(2 * (q->x * q->y + q->w * q->z), q->w * q->w + q->x * q->x - q->y * q->y - q->z * q->z);
+    float result = atan2f(2.0f * (q->x * q->y + q->w * q->z), q->w * q->w + q->x * q->x - q->y * q->y - q->z * q->z);
     return result;
 }
 
@@ -99,7 +99,7 @@ kmBool kmSegment2WithSegmentIntersection( const kmRay2 *segmentA, const kmRay2 *
     if( kmLine2WithLineIntersection( &(segmentA->start), &(segmentA->dir), 
                                     &(segmentB->start), &(segmentB->start),
                                     &ua, &ub, &pt ) && 
-        (0.0 <= ua) && (ua <= 1.0) && (0.0 <= ub) && (ub <= 1.0)) {
+        (0.0f <= ua) && (ua <= 1.0f) && (0.0f <= ub) && (ub <= 1.0f)) {
         intersection->x = pt.x;
         intersection->y = pt.y;
         return KM_TRUE;    
@@ -120,7 +120,7 @@ kmBool kmRay2IntersectLineSegment(const kmRay2* ray, const kmVec2* p1, const kmV
     if( kmLine2WithLineIntersection( &(ray->start), &(ray->dir), 
                                      &(otherSegment.start), &(otherSegment.dir),
                                      &ua, &ub, &pt ) && 
-        (0.0 <= ua) && (0.0 <= ub) && (ub <= 1.0)) {
+        (0.0f <= ua) && (0.0f <= ub) && (ub <= 1.0f)) {
         
         intersection->x = pt.x;
         intersection->y = pt.y;
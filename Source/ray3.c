@@ -24,8 +24,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <kazmath/plane.h>
+#include <kazmath/mat4.h>
 #include <kazmath/ray3.h>
 #include <kazmath/aabb3.h>
+#include <kazmath/sphere.h>
+#include <kazmath/obb3.h>
 
 kmRay3* kmRay3Fill(kmRay3* ray, kmScalar px, kmScalar py, kmScalar pz, kmScalar vx, kmScalar vy, kmScalar vz) {
     ray->start.x = px;
@@ -45,11 +48,226 @@ kmRay3* kmRay3FromPointAndDirection(kmRay3* ray, const kmVec3* point, const kmVe
     return ray;
 }
 
+void kmTriangle3SoAFill(const kmTriangle3SoA* pOut, const kmVec3* vertices, const uint32_t* indices, size_t count) {
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        const kmVec3* a = indices ? &vertices[indices[i * 3 + 0]] : &vertices[i * 3 + 0];
+        const kmVec3* b = indices ? &vertices[indices[i * 3 + 1]] : &vertices[i * 3 + 1];
+        const kmVec3* c = indices ? &vertices[indices[i * 3 + 2]] : &vertices[i * 3 + 2];
+
+        pOut->v0x[i] = a->x;
+        pOut->v0y[i] = a->y;
+        pOut->v0z[i] = a->z;
+        pOut->e1x[i] = b->x - a->x;
+        pOut->e1y[i] = b->y - a->y;
+        pOut->e1z[i] = b->z - a->z;
+        pOut->e2x[i] = c->x - a->x;
+        pOut->e2y[i] = c->y - a->y;
+        pOut->e2z[i] = c->z - a->z;
+    }
+}
+
+kmBool kmRay3IntersectTriangleArray(const kmRay3* ray, const kmTriangle3SoA* triangles, size_t count, kmEnum mode,
+                                    size_t* triangle, kmVec3* intersection, kmVec3* normal, kmScalar* distance,
+                                    kmScalar* u, kmScalar* v) {
+    kmVec3 dir;
+    kmScalar maxSq = kmVec3LengthSq(&ray->dir);
+    kmScalar closest = FLT_MAX;
+    kmBool cull = (mode != KM_RAY3_DOUBLE_SIDED);
+    size_t best = count;
+    size_t i;
+
+    kmVec3Normalize(&dir, &ray->dir);
+
+    /* Only the distance is tracked in the loop so it stays branch free */
+    for(i = 0; i < count; ++i) {
+        kmScalar e1x = triangles->e1x[i], e1y = triangles->e1y[i], e1z = triangles->e1z[i];
+        kmScalar e2x = triangles->e2x[i], e2y = triangles->e2y[i], e2z = triangles->e2z[i];
+
+        kmScalar px = dir.y * e2z - dir.z * e2y;
+        kmScalar py = dir.z * e2x - dir.x * e2z;
+        kmScalar pz = dir.x * e2y - dir.y * e2x;
+        kmScalar det = e1x * px + e1y * py + e1z * pz;
+        kmScalar invDet = 1.0f / det;
+
+        kmScalar tx = ray->start.x - triangles->v0x[i];
+        kmScalar ty = ray->start.y - triangles->v0y[i];
+        kmScalar tz = ray->start.z - triangles->v0z[i];
+        kmScalar tu = invDet * (tx * px + ty * py + tz * pz);
+
+        kmScalar qx = ty * e1z - tz * e1y;
+        kmScalar qy = tz * e1x - tx * e1z;
+        kmScalar qz = tx * e1y - ty * e1x;
+        kmScalar tv = invDet * (dir.x * qx + dir.y * qy + dir.z * qz);
+        kmScalar t = invDet * (e2x * qx + e2y * qy + e2z * qz);
+
+        kmScalar facing = cull ? det : fabsf(det);
+
+        int hit = (facing >= kmEpsilon) &
+                  (tu >= 0.0f) & (tu <= 1.0f) &
+                  (tv >= 0.0f) & (tu + tv <= 1.0f) &
+                  (t > kmEpsilon) & (t * t <= maxSq) & (t < closest);
+
+        closest = hit ? t : closest;
+        best = hit ? i : best;
+    }
+
+    if(best == count) {
+        return KM_FALSE;
+    }
+
+    if(triangle) *triangle = best;
+    if(distance) *distance = closest;
+
+    if(intersection) {
+        intersection->x = ray->start.x + dir.x * closest;
+        intersection->y = ray->start.y + dir.y * closest;
+        intersection->z = ray->start.z + dir.z * closest;
+    }
+
+    if(normal || u || v) {
+        kmVec3 e1, e2, pvec, tvec, qvec;
+        kmScalar invDet;
+
+        kmVec3Fill(&e1, triangles->e1x[best], triangles->e1y[best], triangles->e1z[best]);
+        kmVec3Fill(&e2, triangles->e2x[best], triangles->e2y[best], triangles->e2z[best]);
+
+        if(normal) {
+            kmVec3Cross(normal, &e1, &e2);
+            kmVec3Normalize(normal, normal);
+            if(kmVec3Dot(normal, &dir) > 0.0f) {
+                kmVec3Scale(normal, normal, -1.0f);
+            }
+        }
+
+        kmVec3Cross(&pvec, &dir, &e2);
+        invDet = 1.0f / kmVec3Dot(&e1, &pvec);
+        kmVec3Fill(&tvec, ray->start.x - triangles->v0x[best], ray->start.y - triangles->v0y[best], ray->start.z - triangles->v0z[best]);
+        kmVec3Cross(&qvec, &tvec, &e1);
+
+        if(u) *u = invDet * kmVec3Dot(&tvec, &pvec);
+        if(v) *v = invDet * kmVec3Dot(&dir, &qvec);
+    }
+
+    return KM_TRUE;
+}
+
+kmBool kmRay3OccludedPlane(const kmRay3* ray, const kmPlane* plane, kmScalar maxDistance) {
+    kmScalar length = kmVec3Length(&ray->dir);
+    kmScalar d = plane->a * ray->dir.x + plane->b * ray->dir.y + plane->c * ray->dir.z;
+    kmScalar t;
+
+    if(d == 0.0f) {
+        return KM_FALSE;
+    }
+
+    t = -(plane->a * ray->start.x + plane->b * ray->start.y + plane->c * ray->start.z + plane->d) / d;
+    return t >= 0.0f && t * length < maxDistance;
+}
+
+kmBool kmRay3OccludedAABB3(const kmRay3* ray, const kmAABB3* aabb, kmScalar maxDistance) {
+    kmRay3Precomputed pre;
+    kmRay3PrecomputedFromRay3(&pre, ray);
+    pre.tmax = maxDistance;
+    return kmRay3PrecomputedIntersectAABB3(&pre, aabb, NULL, NULL);
+}
+
+/* Moller-Trumbore on a prepared triangle, exiting at the first failed test */
+static kmBool kmRay3OccludedEdges(const kmVec3* start, const kmVec3* dir, const kmVec3* v0, const kmVec3* e1, const kmVec3* e2,
+                                  kmBool cull, kmScalar maxDistance) {
+    kmVec3 pvec, tvec, qvec;
+    kmScalar det, invDet, u, v, t;
+
+    kmVec3Cross(&pvec, dir, e2);
+    det = kmVec3Dot(e1, &pvec);
+
+    if((cull ? det : fabsf(det)) < kmEpsilon) {
+        return KM_FALSE;
+    }
+
+    invDet = 1.0f / det;
+    kmVec3Subtract(&tvec, start, v0);
+
+    u = invDet * kmVec3Dot(&tvec, &pvec);
+    if(u < 0.0f || u > 1.0f) {
+        return KM_FALSE;
+    }
+
+    kmVec3Cross(&qvec, &tvec, e1);
+    v = invDet * kmVec3Dot(dir, &qvec);
+    if(v < 0.0f || u + v > 1.0f) {
+        return KM_FALSE;
+    }
+
+    t = invDet * kmVec3Dot(e2, &qvec);
+    return t > kmEpsilon && t < maxDistance;
+}
+
+kmBool kmRay3OccludedTriangle(const kmRay3* ray, const kmVec3* v0, const kmVec3* v1, const kmVec3* v2,
+                              kmEnum mode, kmScalar maxDistance) {
+    kmVec3 dir, e1, e2;
+
+    kmVec3Normalize(&dir, &ray->dir);
+    kmVec3Subtract(&e1, v1, v0);
+    kmVec3Subtract(&e2, v2, v0);
+
+    return kmRay3OccludedEdges(&ray->start, &dir, v0, &e1, &e2, mode != KM_RAY3_DOUBLE_SIDED, maxDistance);
+}
+
+static kmBool kmRay3OccludedStream(const kmVec3* start, const kmVec3* dir, const kmTriangle3SoA* triangles, size_t count,
+                                   kmBool cull, kmScalar maxDistance) {
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmVec3 v0, e1, e2;
+
+        kmVec3Fill(&v0, triangles->v0x[i], triangles->v0y[i], triangles->v0z[i]);
+        kmVec3Fill(&e1, triangles->e1x[i], triangles->e1y[i], triangles->e1z[i]);
+        kmVec3Fill(&e2, triangles->e2x[i], triangles->e2y[i], triangles->e2z[i]);
+
+        if(kmRay3OccludedEdges(start, dir, &v0, &e1, &e2, cull, maxDistance)) {
+            return KM_TRUE;
+        }
+    }
+
+    return KM_FALSE;
+}
+
+kmBool kmRay3OccludedTriangleArray(const kmRay3* ray, const kmTriangle3SoA* triangles, size_t count,
+                                   kmEnum mode, kmScalar maxDistance) {
+    kmVec3 dir;
+    kmVec3Normalize(&dir, &ray->dir);
+    return kmRay3OccludedStream(&ray->start, &dir, triangles, count, mode != KM_RAY3_DOUBLE_SIDED, maxDistance);
+}
+
+size_t kmRay3OccludedTargets(const kmVec3* origin, const kmVec3* targets, size_t count,
+                             const kmTriangle3SoA* triangles, size_t triangleCount, kmEnum mode,
+                             kmBool* results) {
+    const kmBool cull = (mode != KM_RAY3_DOUBLE_SIDED);
+    size_t hidden = 0;
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        kmVec3 dir;
+        kmScalar length;
+
+        kmVec3Subtract(&dir, &targets[i], origin);
+        length = kmVec3Length(&dir);
+        kmVec3Normalize(&dir, &dir);
+
+        results[i] = kmRay3OccludedStream(origin, &dir, triangles, triangleCount, cull, length);
+        hidden += results[i];
+    }
+
+    return hidden;
+}
+
 kmBool kmRay3IntersectAABB3(const kmRay3* ray, const kmAABB3* aabb, kmVec3* intersection, kmScalar* distance) {
     //http://gamedev.stackexchange.com/a/18459/15125
     kmVec3 rdir, dirfrac, diff;
     kmVec3Normalize(&rdir, &ray->dir);
-    kmVec3Fill(&dirfrac, 1.0 / rdir.x, 1.0 / rdir.y, 1.0 / rdir.z);
+    kmVec3Fill(&dirfrac, 1.0f / rdir.x, 1.0f / rdir.y, 1.0f / rdir.z);
 
     kmScalar t1 = (aabb->min.x - ray->start.x) * dirfrac.x;
     kmScalar t2 = (aabb->max.x - ray->start.x) * dirfrac.x;
@@ -79,6 +297,129 @@ kmBool kmRay3IntersectAABB3(const kmRay3* ray, const kmAABB3* aabb, kmVec3* inte
     return KM_TRUE;
 }
 
+kmRay3Precomputed* kmRay3PrecomputedFromRay3(kmRay3Precomputed* pOut, const kmRay3* ray) {
+    kmVec3Assign(&pOut->origin, &ray->start);
+    kmVec3Normalize(&pOut->dir, &ray->dir);
+
+    /* Zero components become +/-infinity, see below */
+    pOut->invDir.x = 1.0f / pOut->dir.x;
+    pOut->invDir.y = 1.0f / pOut->dir.y;
+    pOut->invDir.z = 1.0f / pOut->dir.z;
+
+    pOut->sign[0] = pOut->invDir.x < 0.0f;
+    pOut->sign[1] = pOut->invDir.y < 0.0f;
+    pOut->sign[2] = pOut->invDir.z < 0.0f;
+
+    pOut->tmin = 0.0f;
+    pOut->tmax = FLT_MAX;
+
+    return pOut;
+}
+
+kmBool kmRay3PrecomputedIntersectAABB3(const kmRay3Precomputed* ray, const kmAABB3* aabb, kmVec3* intersection, kmScalar* distance) {
+    /* min and max are adjacent, so the sign bit picks the near face */
+    const kmVec3* bounds = &aabb->min;
+
+    kmScalar txNear = (bounds[ray->sign[0]].x - ray->origin.x) * ray->invDir.x;
+    kmScalar txFar = (bounds[1 - ray->sign[0]].x - ray->origin.x) * ray->invDir.x;
+    kmScalar tyNear = (bounds[ray->sign[1]].y - ray->origin.y) * ray->invDir.y;
+    kmScalar tyFar = (bounds[1 - ray->sign[1]].y - ray->origin.y) * ray->invDir.y;
+    kmScalar tzNear = (bounds[ray->sign[2]].z - ray->origin.z) * ray->invDir.z;
+    kmScalar tzFar = (bounds[1 - ray->sign[2]].z - ray->origin.z) * ray->invDir.z;
+
+    /*
+     * A ray parallel to a slab and lying exactly on its face gives
+     * 0 * inf = NaN. kmMax/kmMin return their second argument when the
+     * first is NaN, so keeping the running value second drops those
+     * slabs and treats the face as inside.
+     */
+    kmScalar tmin = kmMax(tzNear, kmMax(tyNear, kmMax(txNear, ray->tmin)));
+    kmScalar tmax = kmMin(tzFar, kmMin(tyFar, kmMin(txFar, ray->tmax)));
+
+    if(tmin > tmax) {
+        return KM_FALSE;
+    }
+
+    if(distance) *distance = tmin;
+    if(intersection) {
+        intersection->x = ray->origin.x + ray->dir.x * tmin;
+        intersection->y = ray->origin.y + ray->dir.y * tmin;
+        intersection->z = ray->origin.z + ray->dir.z * tmin;
+    }
+    return KM_TRUE;
+}
+
+kmRay3Picker* kmRay3PickerFill(kmRay3Picker* pOut, const kmMat4* view, const kmMat4* projection,
+                               kmScalar width, kmScalar height, kmEnum layout) {
+    kmMat4 viewProjection;
+
+    kmMat4Multiply(&viewProjection, projection, view);
+    if(!kmMat4Inverse(&pOut->inverseViewProjection, &viewProjection)) {
+        return NULL;
+    }
+
+    pOut->width = width;
+    pOut->height = height;
+    pOut->layout = layout;
+    return pOut;
+}
+
+void kmRay3FromScreenPoints(kmRay3* pOut, const kmRay3Picker* picker, const kmVec2* points, size_t count) {
+    const kmScalar* m = picker->inverseViewProjection.mat;
+    const kmBool tilt = (picker->layout == KM_SCREEN_LAYOUT_TILT);
+    const kmScalar farZ = tilt ? 0.0f : 1.0f;
+    const kmScalar sx = 2.0f / picker->width;
+    const kmScalar sy = 2.0f / picker->height;
+
+    /*
+     * Unprojecting (nx, ny, z, 1) is nx * col0 + ny * col1 + base(z), so
+     * the depth dependent parts are worked out once for the batch.
+     */
+    kmScalar nearBase[4], farBase[4];
+    size_t i;
+    int r;
+
+    for(r = 0; r < 4; ++r) {
+        nearBase[r] = m[12 + r] - m[8 + r];
+        farBase[r] = m[12 + r] + farZ * m[8 + r];
+    }
+
+    for(i = 0; i < count; ++i) {
+        kmScalar right = points[i].x * sx - 1.0f;
+        kmScalar up = 1.0f - points[i].y * sy;
+
+        /* Tilted clip space has x pointing up the screen and y to the left */
+        kmScalar nx = tilt ? up : right;
+        kmScalar ny = tilt ? -right : up;
+
+        kmScalar n[4], f[4];
+        kmScalar invNearW, invFarW;
+
+        for(r = 0; r < 4; ++r) {
+            kmScalar xy = nx * m[r] + ny * m[4 + r];
+            n[r] = xy + nearBase[r];
+            f[r] = xy + farBase[r];
+        }
+
+        invNearW = 1.0f / n[3];
+        invFarW = 1.0f / f[3];
+
+        pOut[i].start.x = n[0] * invNearW;
+        pOut[i].start.y = n[1] * invNearW;
+        pOut[i].start.z = n[2] * invNearW;
+        pOut[i].dir.x = f[0] * invFarW - pOut[i].start.x;
+        pOut[i].dir.y = f[1] * invFarW - pOut[i].start.y;
+        pOut[i].dir.z = f[2] * invFarW - pOut[i].start.z;
+    }
+}
+
+kmRay3* kmRay3FromScreenPoint(kmRay3* pOut, const kmRay3Picker* picker, kmScalar x, kmScalar y) {
+    kmVec2 point;
+    kmVec2Fill(&point, x, y);
+    kmRay3FromScreenPoints(pOut, picker, &point, 1);
+    return pOut;
+}
+
 kmBool kmRay3IntersectPlane(kmVec3* pOut, const kmRay3* ray, const kmPlane* plane) {
     /*t = - (A*org.x + B*org.y + C*org.z + D) / (A*dir.x + B*dir.y + C*dir.z )*/
 
@@ -129,18 +470,18 @@ kmBool kmRay3IntersectTriangle(const kmRay3* ray, const kmVec3* v0, const kmVec3
         return KM_FALSE;
     }
 
-    inv_det = 1.0 / det;
+    inv_det = 1.0f / det;
 
     kmVec3Subtract(&tvec, &ray->start, v0);
 
     u = inv_det * kmVec3Dot(&tvec, &pvec);
-    if(u < 0.0 || u > 1.0) {
+    if(u < 0.0f || u > 1.0f) {
         return KM_FALSE;
     }
 
     kmVec3Cross(&qvec, &tvec, &e1);
     v = inv_det * kmVec3Dot(&dir, &qvec);
-    if(v < 0.0 || (u + v) > 1.0) {
+    if(v < 0.0f || (u + v) > 1.0f) {
         return KM_FALSE;
     }
 
@@ -158,3 +499,101 @@ kmBool kmRay3IntersectTriangle(const kmRay3* ray, const kmVec3* v0, const kmVec3
 
     return KM_FALSE;
 }
+
+kmBool kmRay3IntersectSphere(const kmRay3* ray, const kmSphere* sphere, kmVec3* intersection, kmScalar* distance) {
+    kmVec3 rdir, m, diff;
+    kmScalar b, c, disc, t;
+
+    kmVec3Normalize(&rdir, &ray->dir);
+    kmVec3Subtract(&m, &ray->start, &sphere->centre);
+
+    b = kmVec3Dot(&m, &rdir);
+    c = kmVec3LengthSq(&m) - sphere->radius * sphere->radius;
+
+    /* Outside and pointing away */
+    if(c > 0.0f && b > 0.0f) {
+        return KM_FALSE;
+    }
+
+    disc = b * b - c;
+    if(disc < 0.0f) {
+        return KM_FALSE;
+    }
+
+    t = -b - sqrtf(disc);
+    if(t < 0.0f) {
+        t = 0.0f;
+    }
+
+    if(distance) *distance = t;
+    if(intersection) {
+        kmVec3Scale(&diff, &rdir, t);
+        kmVec3Add(intersection, &ray->start, &diff);
+    }
+    return KM_TRUE;
+}
+
+kmBool kmRay3IntersectOBB3(const kmRay3* ray, const kmOBB3* obb, kmVec3* intersection, kmScalar* distance) {
+    kmVec3 rdir, diff;
+    kmScalar tmin = 0.0f, tmax = FLT_MAX;
+    const kmScalar extents[3] = { obb->halfExtents.x, obb->halfExtents.y, obb->halfExtents.z };
+    int i;
+
+    kmVec3Normalize(&rdir, &ray->dir);
+    kmVec3Subtract(&diff, &ray->start, &obb->centre);
+
+    for(i = 0; i < 3; ++i) {
+        /* Ray origin and direction along this box axis */
+        kmScalar o = kmVec3Dot(&diff, &obb->axes[i]);
+        kmScalar d = kmVec3Dot(&rdir, &obb->axes[i]);
+
+        if(fabsf(d) < kmEpsilon) {
+            /* Parallel to the slab, miss unless already between the faces */
+            if(o < -extents[i] || o > extents[i]) {
+                return KM_FALSE;
+            }
+        } else {
+            kmScalar inv = 1.0f / d;
+            kmScalar t1 = (-extents[i] - o) * inv;
+            kmScalar t2 = (extents[i] - o) * inv;
+
+            tmin = kmMax(tmin, kmMin(t1, t2));
+            tmax = kmMin(tmax, kmMax(t1, t2));
+
+            if(tmin > tmax) {
+                return KM_FALSE;
+            }
+        }
+    }
+
+    if(distance) *distance = tmin;
+    if(intersection) {
+        kmVec3Scale(&diff, &rdir, tmin);
+        kmVec3Add(intersection, &ray->start, &diff);
+    }
+    return KM_TRUE;
+}
+
+size_t kmRay3IntersectSphereArray(const kmRay3* ray, const kmSphere* spheres, size_t count, kmBool* results) {
+    kmVec3 rdir;
+    size_t i, hits = 0;
+
+    kmVec3Normalize(&rdir, &ray->dir);
+
+    for(i = 0; i < count; ++i) {
+        kmScalar mx = ray->start.x - spheres[i].centre.x;
+        kmScalar my = ray->start.y - spheres[i].centre.y;
+        kmScalar mz = ray->start.z - spheres[i].centre.z;
+        kmScalar b = mx * rdir.x + my * rdir.y + mz * rdir.z;
+        kmScalar c = mx * mx + my * my + mz * mz - spheres[i].radius * spheres[i].radius;
+
+        /* Hit if the start is inside, or the sphere is ahead and the
+         * line passes through it */
+        kmBool hit = (c <= 0.0f) | ((b <= 0.0f) & (b * b - c >= 0.0f));
+
+        results[i] = hit;
+        hits += hit;
+    }
+
+    return hits;
+}
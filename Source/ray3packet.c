@@ -0,0 +1,176 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <kazmath/aabb3.h>
+#include <kazmath/ray3packet.h>
+
+/*
+ * Both packet widths share these loops. The lane count is a constant
+ * at every call site so the compiler can unroll and vectorize them;
+ * without vector units they simply run as scalar code.
+ */
+
+static void kmRay3PacketFill(size_t width, const kmRay3* rays, size_t count,
+                             kmScalar* ox, kmScalar* oy, kmScalar* oz,
+                             kmScalar* dx, kmScalar* dy, kmScalar* dz,
+                             kmScalar* invDx, kmScalar* invDy, kmScalar* invDz,
+                             kmScalar* lengthSq, kmScalar* tmax) {
+    size_t i;
+
+    for(i = 0; i < width; ++i) {
+        kmVec3 dir;
+
+        if(i >= count) {
+            /* A negative range can never be hit by either test */
+            ox[i] = oy[i] = oz[i] = 0.0f;
+            dx[i] = dy[i] = dz[i] = 0.0f;
+            invDx[i] = invDy[i] = invDz[i] = 0.0f;
+            lengthSq[i] = -1.0f;
+            tmax[i] = -1.0f;
+            continue;
+        }
+
+        kmVec3Normalize(&dir, &rays[i].dir);
+
+        ox[i] = rays[i].start.x;
+        oy[i] = rays[i].start.y;
+        oz[i] = rays[i].start.z;
+        dx[i] = dir.x;
+        dy[i] = dir.y;
+        dz[i] = dir.z;
+        invDx[i] = 1.0f / dir.x;
+        invDy[i] = 1.0f / dir.y;
+        invDz[i] = 1.0f / dir.z;
+        lengthSq[i] = kmVec3LengthSq(&rays[i].dir);
+        tmax[i] = FLT_MAX;
+    }
+}
+
+static unsigned kmRay3PacketIntersectAABB3(size_t width, const kmAABB3* aabb,
+                                           const kmScalar* ox, const kmScalar* oy, const kmScalar* oz,
+                                           const kmScalar* invDx, const kmScalar* invDy, const kmScalar* invDz,
+                                           const kmScalar* tmax, kmScalar* distances) {
+    unsigned mask = 0;
+    size_t i;
+
+    for(i = 0; i < width; ++i) {
+        /* The sign of the inverse direction picks the near face */
+        kmScalar nx = invDx[i] < 0.0f ? aabb->max.x : aabb->min.x;
+        kmScalar fx = invDx[i] < 0.0f ? aabb->min.x : aabb->max.x;
+        kmScalar ny = invDy[i] < 0.0f ? aabb->max.y : aabb->min.y;
+        kmScalar fy = invDy[i] < 0.0f ? aabb->min.y : aabb->max.y;
+        kmScalar nz = invDz[i] < 0.0f ? aabb->max.z : aabb->min.z;
+        kmScalar fz = invDz[i] < 0.0f ? aabb->min.z : aabb->max.z;
+
+        /* NaN handling as in kmRay3PrecomputedIntersectAABB3 */
+        kmScalar tNear = kmMax((nz - oz[i]) * invDz[i], kmMax((ny - oy[i]) * invDy[i], kmMax((nx - ox[i]) * invDx[i], 0.0f)));
+        kmScalar tFar = kmMin((fz - oz[i]) * invDz[i], kmMin((fy - oy[i]) * invDy[i], kmMin((fx - ox[i]) * invDx[i], tmax[i])));
+
+        if(distances) distances[i] = tNear;
+        mask |= (unsigned) (tNear <= tFar) << i;
+    }
+
+    return mask;
+}
+
+static unsigned kmRay3PacketIntersectTriangle(size_t width, const kmVec3* v0, const kmVec3* v1, const kmVec3* v2,
+                                              const kmScalar* ox, const kmScalar* oy, const kmScalar* oz,
+                                              const kmScalar* dx, const kmScalar* dy, const kmScalar* dz,
+                                              const kmScalar* lengthSq,
+                                              kmScalar* distances, kmScalar* uOut, kmScalar* vOut) {
+    unsigned mask = 0;
+    kmVec3 e1, e2;
+    size_t i;
+
+    kmVec3Subtract(&e1, v1, v0);
+    kmVec3Subtract(&e2, v2, v0);
+
+    for(i = 0; i < width; ++i) {
+        /* pvec = dir x e2 */
+        kmScalar px = dy[i] * e2.z - dz[i] * e2.y;
+        kmScalar py = dz[i] * e2.x - dx[i] * e2.z;
+        kmScalar pz = dx[i] * e2.y - dy[i] * e2.x;
+        kmScalar det = e1.x * px + e1.y * py + e1.z * pz;
+        kmScalar invDet = 1.0f / det;
+
+        kmScalar tx = ox[i] - v0->x;
+        kmScalar ty = oy[i] - v0->y;
+        kmScalar tz = oz[i] - v0->z;
+        kmScalar u = invDet * (tx * px + ty * py + tz * pz);
+
+        /* qvec = tvec x e1 */
+        kmScalar qx = ty * e1.z - tz * e1.y;
+        kmScalar qy = tz * e1.x - tx * e1.z;
+        kmScalar qz = tx * e1.y - ty * e1.x;
+        kmScalar v = invDet * (dx[i] * qx + dy[i] * qy + dz[i] * qz);
+        kmScalar t = invDet * (e2.x * qx + e2.y * qy + e2.z * qz);
+
+        int hit = (det >= kmEpsilon) &
+                  (u >= 0.0f) & (u <= 1.0f) &
+                  (v >= 0.0f) & (u + v <= 1.0f) &
+                  (t > kmEpsilon) & (t * t <= lengthSq[i]);
+
+        if(distances) distances[i] = t;
+        if(uOut) uOut[i] = u;
+        if(vOut) vOut[i] = v;
+        mask |= (unsigned) hit << i;
+    }
+
+    return mask;
+}
+
+kmRay3Packet4* kmRay3Packet4FromRays(kmRay3Packet4* pOut, const kmRay3* rays, size_t count) {
+    kmRay3PacketFill(4, rays, count, pOut->ox, pOut->oy, pOut->oz, pOut->dx, pOut->dy, pOut->dz,
+                     pOut->invDx, pOut->invDy, pOut->invDz, pOut->lengthSq, pOut->tmax);
+    return pOut;
+}
+
+unsigned kmRay3Packet4IntersectAABB3(const kmRay3Packet4* packet, const kmAABB3* aabb, kmScalar* distances) {
+    return kmRay3PacketIntersectAABB3(4, aabb, packet->ox, packet->oy, packet->oz,
+                                      packet->invDx, packet->invDy, packet->invDz, packet->tmax, distances);
+}
+
+unsigned kmRay3Packet4IntersectTriangle(const kmRay3Packet4* packet, const kmVec3* v0, const kmVec3* v1, const kmVec3* v2,
+                                        kmScalar* distances, kmScalar* u, kmScalar* v) {
+    return kmRay3PacketIntersectTriangle(4, v0, v1, v2, packet->ox, packet->oy, packet->oz,
+                                         packet->dx, packet->dy, packet->dz, packet->lengthSq, distances, u, v);
+}
+
+kmRay3Packet8* kmRay3Packet8FromRays(kmRay3Packet8* pOut, const kmRay3* rays, size_t count) {
+    kmRay3PacketFill(8, rays, count, pOut->ox, pOut->oy, pOut->oz, pOut->dx, pOut->dy, pOut->dz,
+                     pOut->invDx, pOut->invDy, pOut->invDz, pOut->lengthSq, pOut->tmax);
+    return pOut;
+}
+
+unsigned kmRay3Packet8IntersectAABB3(const kmRay3Packet8* packet, const kmAABB3* aabb, kmScalar* distances) {
+    return kmRay3PacketIntersectAABB3(8, aabb, packet->ox, packet->oy, packet->oz,
+                                      packet->invDx, packet->invDy, packet->invDz, packet->tmax, distances);
+}
+
+unsigned kmRay3Packet8IntersectTriangle(const kmRay3Packet8* packet, const kmVec3* v0, const kmVec3* v1, const kmVec3* v2,
+                                        kmScalar* distances, kmScalar* u, kmScalar* v) {
+    return kmRay3PacketIntersectTriangle(8, v0, v1, v2, packet->ox, packet->oy, packet->oz,
+                                         packet->dx, packet->dy, packet->dz, packet->lengthSq, distances, u, v);
+}
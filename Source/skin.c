@@ -0,0 +1,278 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <assert.h>
+
+#include <kazmath/mat4.h>
+#include <kazmath/skin.h>
+
+#include "stride.h"
+
+void kmSkinMat3x4FromMat4(kmSkinMat3x4* pOut, const kmMat4* pIn, size_t count) {
+    size_t i;
+    int c;
+
+    for(i = 0; i < count; ++i) {
+        for(c = 0; c < 4; ++c) {
+            pOut[i].mat[c * 3 + 0] = pIn[i].mat[c * 4 + 0];
+            pOut[i].mat[c * 3 + 1] = pIn[i].mat[c * 4 + 1];
+            pOut[i].mat[c * 3 + 2] = pIn[i].mat[c * 4 + 2];
+        }
+    }
+}
+
+/*
+ * Copies vertices into pOut with every stride of 0 replaced by the
+ * tightly packed stride of its attribute, and does the same for the
+ * output strides.
+ */
+static void kmSkinResolveStrides(kmSkinVertices* pOut, const kmSkinVertices* vertices,
+                                 size_t* positionStride, size_t* normalStride) {
+    size_t indexSize = (vertices->indexType == KM_SKIN_INDEX_U8) ? sizeof(uint8_t) : sizeof(uint16_t);
+    size_t weightSize = (vertices->weightType == KM_SKIN_WEIGHT_U8) ? sizeof(uint8_t) : sizeof(kmScalar);
+
+    *pOut = *vertices;
+    if(!pOut->positionStride) pOut->positionStride = sizeof(kmScalar) * 3;
+    if(!pOut->normalStride) pOut->normalStride = sizeof(kmScalar) * 3;
+    if(!pOut->indexStride) pOut->indexStride = indexSize * vertices->influences;
+    if(!pOut->weightStride) pOut->weightStride = weightSize * vertices->influences;
+    if(!*positionStride) *positionStride = sizeof(kmScalar) * 3;
+    if(!*normalStride) *normalStride = sizeof(kmScalar) * 3;
+}
+
+/*
+ * Reads the influences of vertex i whatever their format, for the
+ * kernels that are not specialized.
+ */
+static void kmSkinFetch(const kmSkinVertices* vertices, size_t i,
+                        unsigned indices[KM_SKIN_MAX_INFLUENCES],
+                        kmScalar weights[KM_SKIN_MAX_INFLUENCES]) {
+    const char* index = KM_STRIDED_AT(char, vertices->indices, vertices->indexStride, i);
+    const char* weight = KM_STRIDED_AT(char, vertices->weights, vertices->weightStride, i);
+    unsigned j;
+
+    for(j = 0; j < vertices->influences; ++j) {
+        indices[j] = (vertices->indexType == KM_SKIN_INDEX_U8) ?
+            ((const uint8_t*) index)[j] : ((const uint16_t*) index)[j];
+        weights[j] = (vertices->weightType == KM_SKIN_WEIGHT_U8) ?
+            (kmScalar) ((const uint8_t*) weight)[j] * (1.0f / 255.0f) : ((const kmScalar*) weight)[j];
+    }
+}
+
+/*
+ * The palette is read as matrixStride floats per bone, each bone being
+ * the x, y, z axes and the translation, columnStride floats apart. That
+ * covers both kmMat4 and kmSkinMat3x4 with one kernel.
+ */
+static inline void kmSkinAccumulate(kmScalar m[12], const kmScalar* bone, size_t columnStride, kmScalar w) {
+    const kmScalar* x = bone;
+    const kmScalar* y = bone + columnStride;
+    const kmScalar* z = bone + columnStride * 2;
+    const kmScalar* t = bone + columnStride * 3;
+
+    m[0] += x[0] * w; m[1] += x[1] * w; m[2] += x[2] * w;
+    m[3] += y[0] * w; m[4] += y[1] * w; m[5] += y[2] * w;
+    m[6] += z[0] * w; m[7] += z[1] * w; m[8] += z[2] * w;
+    m[9] += t[0] * w; m[10] += t[1] * w; m[11] += t[2] * w;
+}
+
+static inline void kmSkinApply(const kmScalar m[12], const kmScalar* p, kmScalar* out, kmScalar translate) {
+    kmScalar x = p[0], y = p[1], z = p[2];
+
+    out[0] = m[0] * x + m[3] * y + m[6] * z + m[9] * translate;
+    out[1] = m[1] * x + m[4] * y + m[7] * z + m[10] * translate;
+    out[2] = m[2] * x + m[5] * y + m[8] * z + m[11] * translate;
+}
+
+typedef void (*kmSkinKernel)(void*, size_t, void*, size_t, const kmSkinVertices*,
+                             const kmScalar*, size_t, size_t, size_t);
+
+/*
+ * Defines a linear blend kernel for influences bones per vertex with
+ * the given index type and weight conversion, so that the inner loop
+ * has no format checks and a fixed trip count.
+ */
+#define KM_SKIN_LINEAR_BLEND_KERNEL(name, influences, IndexType, WeightType, weightScale) \
+static void name(void* positions, size_t positionStride, void* normals, size_t normalStride, \
+                 const kmSkinVertices* vertices, const kmScalar* palette,               \
+                 size_t matrixStride, size_t columnStride, size_t count) {              \
+    kmBool skinNormals = normals && vertices->normals;                                  \
+    size_t i;                                                                           \
+    int j;                                                                              \
+                                                                                        \
+    for(i = 0; i < count; ++i) {                                                        \
+        const IndexType* indices =                                                      \
+            KM_STRIDED_AT(IndexType, vertices->indices, vertices->indexStride, i);      \
+        const WeightType* weights =                                                     \
+            KM_STRIDED_AT(WeightType, vertices->weights, vertices->weightStride, i);    \
+        kmScalar m[12] = { 0.0f };                                                      \
+                                                                                        \
+        for(j = 0; j < (influences); ++j) {                                             \
+            kmSkinAccumulate(m, &palette[indices[j] * matrixStride], columnStride,      \
+                             (kmScalar) weights[j] * (weightScale));                    \
+        }                                                                               \
+                                                                                        \
+        kmSkinApply(m, KM_STRIDED_AT(kmScalar, vertices->positions,                     \
+                                     vertices->positionStride, i),                      \
+                    KM_STRIDED_OUT(kmScalar, positions, positionStride, i), 1.0f);      \
+                                                                                        \
+        if(skinNormals) {                                                               \
+            kmSkinApply(m, KM_STRIDED_AT(kmScalar, vertices->normals,                   \
+                                         vertices->normalStride, i),                    \
+                        KM_STRIDED_OUT(kmScalar, normals, normalStride, i), 0.0f);      \
+        }                                                                               \
+    }                                                                                   \
+}
+
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend1U8U8, 1, uint8_t, uint8_t, 1.0f / 255.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend1U8F, 1, uint8_t, kmScalar, 1.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend1U16U8, 1, uint16_t, uint8_t, 1.0f / 255.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend1U16F, 1, uint16_t, kmScalar, 1.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend2U8U8, 2, uint8_t, uint8_t, 1.0f / 255.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend2U8F, 2, uint8_t, kmScalar, 1.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend2U16U8, 2, uint16_t, uint8_t, 1.0f / 255.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend2U16F, 2, uint16_t, kmScalar, 1.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend4U8U8, 4, uint8_t, uint8_t, 1.0f / 255.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend4U8F, 4, uint8_t, kmScalar, 1.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend4U16U8, 4, uint16_t, uint8_t, 1.0f / 255.0f)
+KM_SKIN_LINEAR_BLEND_KERNEL(kmSkinLinearBlend4U16F, 4, uint16_t, kmScalar, 1.0f)
+
+/* Indexed by influence count, then index type, then weight type */
+static const kmSkinKernel kmSkinLinearBlendKernels[3][2][2] = {
+    { { kmSkinLinearBlend1U8U8, kmSkinLinearBlend1U8F }, { kmSkinLinearBlend1U16U8, kmSkinLinearBlend1U16F } },
+    { { kmSkinLinearBlend2U8U8, kmSkinLinearBlend2U8F }, { kmSkinLinearBlend2U16U8, kmSkinLinearBlend2U16F } },
+    { { kmSkinLinearBlend4U8U8, kmSkinLinearBlend4U8F }, { kmSkinLinearBlend4U16U8, kmSkinLinearBlend4U16F } }
+};
+
+static kmSkinKernel kmSkinSelectKernel(const kmSkinVertices* vertices) {
+    unsigned slot = (vertices->influences == 4) ? 2 : vertices->influences - 1;
+
+    assert(vertices->influences == 1 || vertices->influences == 2 || vertices->influences == 4);
+    assert(vertices->indexType <= KM_SKIN_INDEX_U16 && vertices->weightType <= KM_SKIN_WEIGHT_FLOAT);
+
+    return kmSkinLinearBlendKernels[slot][vertices->indexType][vertices->weightType];
+}
+
+void kmSkinLinearBlend(void* positions, size_t positionStride,
+                       void* normals, size_t normalStride,
+                       const kmSkinVertices* vertices,
+                       const kmMat4* palette, size_t count) {
+    kmSkinVertices packed;
+
+    kmSkinResolveStrides(&packed, vertices, &positionStride, &normalStride);
+    kmSkinSelectKernel(&packed)(positions, positionStride, normals, normalStride,
+                                &packed, palette->mat, 16, 4, count);
+}
+
+void kmSkinLinearBlend3x4(void* positions, size_t positionStride,
+                          void* normals, size_t normalStride,
+                          const kmSkinVertices* vertices,
+                          const kmSkinMat3x4* palette, size_t count) {
+    kmSkinVertices packed;
+
+    kmSkinResolveStrides(&packed, vertices, &positionStride, &normalStride);
+    kmSkinSelectKernel(&packed)(positions, positionStride, normals, normalStride,
+                                &packed, palette->mat, 12, 3, count);
+}
+
+void kmSkinDualQuaternion(void* positions, size_t positionStride,
+                          void* normals, size_t normalStride,
+                          const kmSkinVertices* vertices,
+                          const kmDualQuaternion* palette, size_t count) {
+    kmBool skinNormals = normals && vertices->normals;
+    kmSkinVertices packed;
+    size_t i;
+
+    kmSkinResolveStrides(&packed, vertices, &positionStride, &normalStride);
+    vertices = &packed;
+
+    for(i = 0; i < count; ++i) {
+        unsigned indices[KM_SKIN_MAX_INFLUENCES] = { 0 };
+        kmScalar weights[KM_SKIN_MAX_INFLUENCES];
+        const kmDualQuaternion* first;
+        const kmScalar* p = KM_STRIDED_AT(kmScalar, vertices->positions, vertices->positionStride, i);
+        kmScalar rx = 0.0f, ry = 0.0f, rz = 0.0f, rw = 0.0f;
+        kmScalar dx = 0.0f, dy = 0.0f, dz = 0.0f, dw = 0.0f;
+        kmScalar lengthSq, invLength, cx, cy, cz, tx, ty, tz;
+        kmScalar* out;
+        unsigned j;
+
+        kmSkinFetch(vertices, i, indices, weights);
+        first = &palette[indices[0]];
+
+        for(j = 0; j < vertices->influences; ++j) {
+            const kmDualQuaternion* dq = &palette[indices[j]];
+            kmScalar d = dq->real.x * first->real.x + dq->real.y * first->real.y +
+                         dq->real.z * first->real.z + dq->real.w * first->real.w;
+
+            /* Blend along the shortest path relative to the first bone */
+            kmScalar w = (d < 0.0f) ? -weights[j] : weights[j];
+
+            rx += dq->real.x * w; ry += dq->real.y * w; rz += dq->real.z * w; rw += dq->real.w * w;
+            dx += dq->dual.x * w; dy += dq->dual.y * w; dz += dq->dual.z * w; dw += dq->dual.w * w;
+        }
+
+        lengthSq = rx * rx + ry * ry + rz * rz + rw * rw;
+
+        /* Zero weights leave nothing to normalize, use the first bone */
+        if(lengthSq < kmEpsilon) {
+            rx = first->real.x; ry = first->real.y; rz = first->real.z; rw = first->real.w;
+            dx = first->dual.x; dy = first->dual.y; dz = first->dual.z; dw = first->dual.w;
+            lengthSq = 1.0f;
+        }
+
+        invLength = 1.0f / sqrtf(lengthSq);
+        rx *= invLength; ry *= invLength; rz *= invLength; rw *= invLength;
+        dx *= invLength; dy *= invLength; dz *= invLength; dw *= invLength;
+
+        /* Translation, see kmDualQuaternionGetTranslation */
+        tx = 2.0f * (rw * dx - dw * rx + (ry * dz - rz * dy));
+        ty = 2.0f * (rw * dy - dw * ry + (rz * dx - rx * dz));
+        tz = 2.0f * (rw * dz - dw * rz + (rx * dy - ry * dx));
+
+        /* Rotation, see kmDualQuaternionTransformNormal */
+        cx = ry * p[2] - rz * p[1] + rw * p[0];
+        cy = rz * p[0] - rx * p[2] + rw * p[1];
+        cz = rx * p[1] - ry * p[0] + rw * p[2];
+
+        out = KM_STRIDED_OUT(kmScalar, positions, positionStride, i);
+        out[0] = p[0] + 2.0f * (ry * cz - rz * cy) + tx;
+        out[1] = p[1] + 2.0f * (rz * cx - rx * cz) + ty;
+        out[2] = p[2] + 2.0f * (rx * cy - ry * cx) + tz;
+
+        if(skinNormals) {
+            const kmScalar* n = KM_STRIDED_AT(kmScalar, vertices->normals, vertices->normalStride, i);
+
+            cx = ry * n[2] - rz * n[1] + rw * n[0];
+            cy = rz * n[0] - rx * n[2] + rw * n[1];
+            cz = rx * n[1] - ry * n[0] + rw * n[2];
+
+            out = KM_STRIDED_OUT(kmScalar, normals, normalStride, i);
+            out[0] = n[0] + 2.0f * (ry * cz - rz * cy);
+            out[1] = n[1] + 2.0f * (rz * cx - rx * cz);
+            out[2] = n[2] + 2.0f * (rx * cy - ry * cx);
+        }
+    }
+}
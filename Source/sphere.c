@@ -0,0 +1,310 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <kazmath/sphere.h>
+#include <kazmath/aabb3.h>
+
+#include "stride.h"
+
+kmSphere* kmSphereFill(kmSphere* pOut, const kmVec3* centre, kmScalar radius) {
+    if(centre) {
+        kmVec3Assign(&pOut->centre, centre);
+    } else {
+        kmVec3Zero(&pOut->centre);
+    }
+
+    pOut->radius = radius;
+    return pOut;
+}
+
+kmSphere* kmSphereAssign(kmSphere* pOut, const kmSphere* pIn) {
+    kmVec3Assign(&pOut->centre, &pIn->centre);
+    pOut->radius = pIn->radius;
+    return pOut;
+}
+
+kmSphere* kmSphereExpandToContain(kmSphere* pOut, const kmSphere* pIn, const kmVec3* point) {
+    kmVec3 d;
+    kmScalar distSq, dist, newRadius, k;
+
+    kmVec3Subtract(&d, point, &pIn->centre);
+    distSq = kmVec3LengthSq(&d);
+
+    if(distSq <= pIn->radius * pIn->radius) {
+        return kmSphereAssign(pOut, pIn);
+    }
+
+    /* Move the centre towards the point so the far side of the
+     * sphere stays where it was */
+    dist = sqrtf(distSq);
+    newRadius = (pIn->radius + dist) * 0.5f;
+    k = (newRadius - pIn->radius) / dist;
+
+    pOut->centre.x = pIn->centre.x + d.x * k;
+    pOut->centre.y = pIn->centre.y + d.y * k;
+    pOut->centre.z = pIn->centre.z + d.z * k;
+    pOut->radius = newRadius;
+
+    return pOut;
+}
+
+kmSphere* kmSphereFromPoints(kmSphere* pOut, const kmVec3* points, size_t stride, size_t count) {
+    size_t i;
+    size_t minX = 0, maxX = 0, minY = 0, maxY = 0, minZ = 0, maxZ = 0;
+    const kmVec3 *a, *b;
+    kmScalar dx, dy, dz;
+    kmSphere result;
+
+    if(!count) {
+        return kmSphereFill(pOut, NULL, 0.0f);
+    }
+
+    if(!stride) stride = sizeof(kmVec3);
+
+    /* Find the extreme points along each axis */
+    for(i = 1; i < count; ++i) {
+        const kmVec3* p = KM_STRIDED_AT(kmVec3, points, stride, i);
+        if(p->x < KM_STRIDED_AT(kmVec3, points, stride, minX)->x) minX = i;
+        if(p->x > KM_STRIDED_AT(kmVec3, points, stride, maxX)->x) maxX = i;
+        if(p->y < KM_STRIDED_AT(kmVec3, points, stride, minY)->y) minY = i;
+        if(p->y > KM_STRIDED_AT(kmVec3, points, stride, maxY)->y) maxY = i;
+        if(p->z < KM_STRIDED_AT(kmVec3, points, stride, minZ)->z) minZ = i;
+        if(p->z > KM_STRIDED_AT(kmVec3, points, stride, maxZ)->z) maxZ = i;
+    }
+
+    /* Start with the sphere spanning the most separated pair */
+    {
+        kmVec3 d;
+        kmScalar distX, distY, distZ;
+
+        kmVec3Subtract(&d, KM_STRIDED_AT(kmVec3, points, stride, maxX), KM_STRIDED_AT(kmVec3, points, stride, minX));
+        distX = kmVec3LengthSq(&d);
+        kmVec3Subtract(&d, KM_STRIDED_AT(kmVec3, points, stride, maxY), KM_STRIDED_AT(kmVec3, points, stride, minY));
+        distY = kmVec3LengthSq(&d);
+        kmVec3Subtract(&d, KM_STRIDED_AT(kmVec3, points, stride, maxZ), KM_STRIDED_AT(kmVec3, points, stride, minZ));
+        distZ = kmVec3LengthSq(&d);
+
+        a = KM_STRIDED_AT(kmVec3, points, stride, minX);
+        b = KM_STRIDED_AT(kmVec3, points, stride, maxX);
+        if(distY > distX && distY > distZ) {
+            a = KM_STRIDED_AT(kmVec3, points, stride, minY);
+            b = KM_STRIDED_AT(kmVec3, points, stride, maxY);
+        } else if(distZ > distX && distZ > distY) {
+            a = KM_STRIDED_AT(kmVec3, points, stride, minZ);
+            b = KM_STRIDED_AT(kmVec3, points, stride, maxZ);
+        }
+    }
+
+    dx = b->x - a->x;
+    dy = b->y - a->y;
+    dz = b->z - a->z;
+
+    kmVec3Fill(&result.centre, (a->x + b->x) * 0.5f, (a->y + b->y) * 0.5f, (a->z + b->z) * 0.5f);
+    result.radius = sqrtf(dx * dx + dy * dy + dz * dz) * 0.5f;
+
+    /* Grow it to take in the stragglers */
+    for(i = 0; i < count; ++i) {
+        kmSphereExpandToContain(&result, &result, KM_STRIDED_AT(kmVec3, points, stride, i));
+    }
+
+    return kmSphereAssign(pOut, &result);
+}
+
+kmSphere* kmSphereRefine(kmSphere* pOut, const kmSphere* pIn, const kmVec3* points, size_t stride, size_t count, kmUchar iterations) {
+    kmSphere best, current;
+    kmUchar k;
+    size_t i;
+
+    kmSphereAssign(&best, pIn);
+
+    if(!count) {
+        return kmSphereAssign(pOut, &best);
+    }
+
+    if(!stride) stride = sizeof(kmVec3);
+
+    kmSphereAssign(&current, &best);
+
+    for(k = 0; k < iterations; ++k) {
+        /* Rotate the starting point on each pass; growing is order
+         * dependent so each pass can settle somewhere different */
+        size_t start = (count * (k + 1)) / ((size_t) iterations + 1);
+
+        current.radius *= 0.95f;
+
+        for(i = 0; i < count; ++i) {
+            size_t j = start + i;
+            if(j >= count) j -= count;
+            kmSphereExpandToContain(&current, &current, KM_STRIDED_AT(kmVec3, points, stride, j));
+        }
+
+        if(current.radius < best.radius) {
+            kmSphereAssign(&best, &current);
+        }
+    }
+
+    return kmSphereAssign(pOut, &best);
+}
+
+kmSphere* kmSphereFromAABB3(kmSphere* pOut, const kmAABB3* aabb) {
+    kmVec3 half;
+
+    kmAABB3Centre(aabb, &pOut->centre);
+
+    kmVec3Subtract(&half, &aabb->max, &aabb->min);
+    pOut->radius = kmVec3Length(&half) * 0.5f;
+
+    return pOut;
+}
+
+kmSphere* kmSphereMerge(kmSphere* pOut, const kmSphere* s1, const kmSphere* s2) {
+    kmVec3 d;
+    kmScalar dist, radius;
+
+    kmVec3Subtract(&d, &s2->centre, &s1->centre);
+    dist = kmVec3Length(&d);
+
+    /* One sphere already holds the other */
+    if(dist + s2->radius <= s1->radius) {
+        return kmSphereAssign(pOut, s1);
+    }
+
+    if(dist + s1->radius <= s2->radius) {
+        return kmSphereAssign(pOut, s2);
+    }
+
+    radius = (dist + s1->radius + s2->radius) * 0.5f;
+
+    /* dist > 0 here, coincident centres are caught above */
+    kmVec3Scale(&d, &d, (radius - s1->radius) / dist);
+    kmVec3Add(&pOut->centre, &s1->centre, &d);
+    pOut->radius = radius;
+
+    return pOut;
+}
+
+kmBool kmSphereContainsPoint(const kmSphere* sphere, const kmVec3* point) {
+    kmVec3 d;
+    kmVec3Subtract(&d, point, &sphere->centre);
+    return kmVec3LengthSq(&d) <= sphere->radius * sphere->radius;
+}
+
+kmEnum kmSphereContainsSphere(const kmSphere* container, const kmSphere* to_check) {
+    kmVec3 d;
+    kmScalar distSq, reach;
+
+    kmVec3Subtract(&d, &to_check->centre, &container->centre);
+    distSq = kmVec3LengthSq(&d);
+
+    reach = container->radius + to_check->radius;
+    if(distSq > reach * reach) {
+        return KM_CONTAINS_NONE;
+    }
+
+    reach = container->radius - to_check->radius;
+    if(reach >= 0 && distSq <= reach * reach) {
+        return KM_CONTAINS_ALL;
+    }
+
+    return KM_CONTAINS_PARTIAL;
+}
+
+kmBool kmSphereIntersectsSphere(const kmSphere* s1, const kmSphere* s2) {
+    kmVec3 d;
+    kmScalar r = s1->radius + s2->radius;
+
+    kmVec3Subtract(&d, &s2->centre, &s1->centre);
+    return kmVec3LengthSq(&d) <= r * r;
+}
+
+kmBool kmSphereIntersectsAABB3(const kmSphere* sphere, const kmAABB3* aabb) {
+    /* Squared distance from the centre to the closest point in the box */
+    const kmVec3* c = &sphere->centre;
+    kmScalar dx = kmMax(kmMax(aabb->min.x - c->x, 0.0f), c->x - aabb->max.x);
+    kmScalar dy = kmMax(kmMax(aabb->min.y - c->y, 0.0f), c->y - aabb->max.y);
+    kmScalar dz = kmMax(kmMax(aabb->min.z - c->z, 0.0f), c->z - aabb->max.z);
+
+    return (dx * dx + dy * dy + dz * dz) <= sphere->radius * sphere->radius;
+}
+
+KM_POINT_CLASSIFICATION kmSphereClassifyPlane(const kmSphere* sphere, const kmPlane* plane) {
+    kmScalar distance = kmPlaneDotCoord(plane, &sphere->centre);
+
+    if(distance > sphere->radius) return POINT_INFRONT_OF_PLANE;
+    if(distance < -sphere->radius) return POINT_BEHIND_PLANE;
+
+    return POINT_ON_PLANE;
+}
+
+size_t kmSphereIntersectsSphereArray(const kmSphere* spheres, size_t count, const kmSphere* other, kmBool* results) {
+    size_t i, hits = 0;
+    const kmScalar ox = other->centre.x;
+    const kmScalar oy = other->centre.y;
+    const kmScalar oz = other->centre.z;
+
+    for(i = 0; i < count; ++i) {
+        kmScalar dx = spheres[i].centre.x - ox;
+        kmScalar dy = spheres[i].centre.y - oy;
+        kmScalar dz = spheres[i].centre.z - oz;
+        kmScalar r = spheres[i].radius + other->radius;
+        kmBool hit = (dx * dx + dy * dy + dz * dz) <= r * r;
+
+        results[i] = hit;
+        hits += hit;
+    }
+
+    return hits;
+}
+
+size_t kmSphereIntersectsAABB3Array(const kmSphere* spheres, size_t count, const kmAABB3* aabb, kmBool* results) {
+    size_t i, hits = 0;
+
+    for(i = 0; i < count; ++i) {
+        kmBool hit = kmSphereIntersectsAABB3(&spheres[i], aabb);
+        results[i] = hit;
+        hits += hit;
+    }
+
+    return hits;
+}
+
+size_t kmSphereClassifyPlaneArray(const kmSphere* spheres, size_t count, const kmPlane* plane, KM_POINT_CLASSIFICATION* results) {
+    size_t i, hits = 0;
+
+    for(i = 0; i < count; ++i) {
+        kmScalar distance = plane->a * spheres[i].centre.x +
+                            plane->b * spheres[i].centre.y +
+                            plane->c * spheres[i].centre.z + plane->d;
+        kmScalar r = spheres[i].radius;
+
+        /* Evaluates to -1, 0 or 1 without branching */
+        int result = (distance > r) - (distance < -r);
+
+        results[i] = (KM_POINT_CLASSIFICATION) result;
+        hits += (result >= 0);
+    }
+
+    return hits;
+}
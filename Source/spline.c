@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <kazmath/spline.h>
+
+kmVec3Cubic* kmVec3CubicFromHermite(kmVec3Cubic* pOut, const kmVec3* p0, const kmVec3* m0,
+                                    const kmVec3* p1, const kmVec3* m1) {
+    /* Copy first, the inputs may alias pOut */
+    kmVec3 P0 = *p0, M0 = *m0, P1 = *p1, M1 = *m1;
+
+    kmVec3Fill(&pOut->a,
+               2.0f * (P0.x - P1.x) + M0.x + M1.x,
+               2.0f * (P0.y - P1.y) + M0.y + M1.y,
+               2.0f * (P0.z - P1.z) + M0.z + M1.z);
+    kmVec3Fill(&pOut->b,
+               3.0f * (P1.x - P0.x) - 2.0f * M0.x - M1.x,
+               3.0f * (P1.y - P0.y) - 2.0f * M0.y - M1.y,
+               3.0f * (P1.z - P0.z) - 2.0f * M0.z - M1.z);
+    pOut->c = M0;
+    pOut->d = P0;
+
+    return pOut;
+}
+
+kmVec3Cubic* kmVec3CubicFromCatmullRom(kmVec3Cubic* pOut, const kmVec3* p0, const kmVec3* p1,
+                                       const kmVec3* p2, const kmVec3* p3) {
+    kmVec3 m1, m2;
+
+    kmVec3Fill(&m1, (p2->x - p0->x) * 0.5f, (p2->y - p0->y) * 0.5f, (p2->z - p0->z) * 0.5f);
+    kmVec3Fill(&m2, (p3->x - p1->x) * 0.5f, (p3->y - p1->y) * 0.5f, (p3->z - p1->z) * 0.5f);
+
+    return kmVec3CubicFromHermite(pOut, p1, &m1, p2, &m2);
+}
+
+void kmVec3CubicFromCatmullRomArray(kmVec3Cubic* pOut, const kmVec3* points, size_t count) {
+    size_t i;
+
+    for(i = 0; i + 1 < count; ++i) {
+        const kmVec3* p0 = &points[i ? i - 1 : 0];
+        const kmVec3* p3 = &points[i + 2 < count ? i + 2 : i + 1];
+
+        kmVec3CubicFromCatmullRom(&pOut[i], p0, &points[i], &points[i + 1], p3);
+    }
+}
+
+kmVec3* kmVec3CubicEvaluate(kmVec3* pOut, const kmVec3Cubic* cubic, kmScalar t) {
+    kmVec3CubicEvaluateArray(pOut, cubic, NULL, t, 1);
+    return pOut;
+}
+
+kmVec3* kmVec3CubicDerivative(kmVec3* pOut, const kmVec3Cubic* cubic, kmScalar t) {
+    return kmVec3Fill(pOut,
+                      (3.0f * cubic->a.x * t + 2.0f * cubic->b.x) * t + cubic->c.x,
+                      (3.0f * cubic->a.y * t + 2.0f * cubic->b.y) * t + cubic->c.y,
+                      (3.0f * cubic->a.z * t + 2.0f * cubic->b.z) * t + cubic->c.z);
+}
+
+void kmVec3CubicEvaluateArray(kmVec3* pOut, const kmVec3Cubic* cubics, const kmScalar* t,
+                              kmScalar uniformT, size_t count) {
+    size_t i;
+
+    for(i = 0; i < count; ++i) {
+        const kmVec3Cubic* c = &cubics[i];
+        kmScalar ti = t ? t[i] : uniformT;
+
+        pOut[i].x = ((c->a.x * ti + c->b.x) * ti + c->c.x) * ti + c->d.x;
+        pOut[i].y = ((c->a.y * ti + c->b.y) * ti + c->c.y) * ti + c->d.y;
+        pOut[i].z = ((c->a.z * ti + c->b.z) * ti + c->c.z) * ti + c->d.z;
+    }
+}
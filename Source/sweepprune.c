@@ -0,0 +1,454 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <kazmath/sweepprune.h>
+
+#define INITIAL_SIZE 64
+
+#define PAIR_EMPTY (~(uint64_t) 0)
+#define PAIR_TOMBSTONE (~(uint64_t) 0 - 1)
+
+#define ENDPOINT_PROXY(e) ((e).data >> 1)
+#define ENDPOINT_IS_MAX(e) ((e).data & 1)
+
+static kmScalar kmSAPAxisMin(const kmAABB3* box, int axis) {
+    return axis == 0 ? box->min.x : (axis == 1 ? box->min.y : box->min.z);
+}
+
+static kmScalar kmSAPAxisMax(const kmAABB3* box, int axis) {
+    return axis == 0 ? box->max.x : (axis == 1 ? box->max.y : box->max.z);
+}
+
+/* Inclusive test matching the endpoint order, where a min sorts before an equal max */
+static kmBool kmSAPOverlaps(const kmAABB3* a, const kmAABB3* b) {
+    return a->min.x <= b->max.x && b->min.x <= a->max.x &&
+           a->min.y <= b->max.y && b->min.y <= a->max.y &&
+           a->min.z <= b->max.z && b->min.z <= a->max.z;
+}
+
+static uint64_t kmSAPPairKey(uint32_t a, uint32_t b) {
+    return a < b ? ((uint64_t) a << 32) | b : ((uint64_t) b << 32) | a;
+}
+
+static uint32_t kmSAPPairHash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return (uint32_t) key;
+}
+
+/* Returns the slot holding key, or the first free slot on its probe sequence */
+static uint32_t kmSAPPairFind(const kmSweepAndPrune* sap, uint64_t key, kmBool* found) {
+    uint32_t mask = sap->pairCapacity - 1;
+    uint32_t slot = kmSAPPairHash(key) & mask;
+    uint32_t free = UINT32_MAX;
+
+    for(;;) {
+        uint64_t k = sap->pairKeys[slot];
+
+        if(k == key) {
+            *found = KM_TRUE;
+            return slot;
+        }
+
+        if(k == PAIR_EMPTY) {
+            *found = KM_FALSE;
+            return free != UINT32_MAX ? free : slot;
+        }
+
+        if(k == PAIR_TOMBSTONE && free == UINT32_MAX) {
+            free = slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+}
+
+static kmBool kmSAPPairReserve(kmSweepAndPrune* sap) {
+    uint64_t* oldKeys = sap->pairKeys;
+    uint32_t oldCapacity = sap->pairCapacity;
+    uint32_t capacity = oldCapacity ? oldCapacity : INITIAL_SIZE;
+    uint32_t i;
+
+    /* Keep used and deleted slots below half of the table */
+    if((sap->pairCount + sap->pairTombstones + 1) * 2 <= oldCapacity) {
+        return KM_TRUE;
+    }
+
+    while((sap->pairCount + 1) * 2 > capacity) {
+        capacity *= 2;
+    }
+
+    sap->pairKeys = (uint64_t*) malloc(sizeof(uint64_t) * capacity);
+    if(!sap->pairKeys) {
+        sap->pairKeys = oldKeys;
+        return KM_FALSE;
+    }
+
+    memset(sap->pairKeys, 0xFF, sizeof(uint64_t) * capacity);
+    sap->pairCapacity = capacity;
+    sap->pairTombstones = 0;
+
+    for(i = 0; i < oldCapacity; ++i) {
+        if(oldKeys[i] != PAIR_EMPTY && oldKeys[i] != PAIR_TOMBSTONE) {
+            kmBool found;
+            sap->pairKeys[kmSAPPairFind(sap, oldKeys[i], &found)] = oldKeys[i];
+        }
+    }
+
+    free(oldKeys);
+    return KM_TRUE;
+}
+
+static kmBool kmSAPPushEvent(kmSAPPair** events, uint32_t* count, uint32_t* capacity, uint64_t key) {
+    if(*count == *capacity) {
+        uint32_t newCapacity = *capacity ? *capacity * 2 : INITIAL_SIZE;
+        kmSAPPair* newEvents = (kmSAPPair*) realloc(*events, sizeof(kmSAPPair) * newCapacity);
+        if(!newEvents) {
+            return KM_FALSE;
+        }
+        *events = newEvents;
+        *capacity = newCapacity;
+    }
+
+    (*events)[*count].a = (uint32_t) (key >> 32);
+    (*events)[*count].b = (uint32_t) key;
+    ++*count;
+    return KM_TRUE;
+}
+
+static kmBool kmSAPAddPair(kmSweepAndPrune* sap, uint32_t a, uint32_t b) {
+    uint64_t key = kmSAPPairKey(a, b);
+    uint32_t slot;
+    kmBool found;
+
+    if(!kmSAPPairReserve(sap)) {
+        return KM_FALSE;
+    }
+
+    slot = kmSAPPairFind(sap, key, &found);
+    if(found) {
+        return KM_TRUE;
+    }
+
+    if(sap->pairKeys[slot] == PAIR_TOMBSTONE) {
+        --sap->pairTombstones;
+    }
+
+    sap->pairKeys[slot] = key;
+    ++sap->pairCount;
+    return kmSAPPushEvent(&sap->added, &sap->addedCount, &sap->addedCapacity, key);
+}
+
+static kmBool kmSAPRemovePair(kmSweepAndPrune* sap, uint32_t a, uint32_t b) {
+    uint64_t key = kmSAPPairKey(a, b);
+    uint32_t slot;
+    kmBool found;
+
+    if(!sap->pairCapacity) {
+        return KM_TRUE;
+    }
+
+    slot = kmSAPPairFind(sap, key, &found);
+    if(!found) {
+        return KM_TRUE;
+    }
+
+    sap->pairKeys[slot] = PAIR_TOMBSTONE;
+    --sap->pairCount;
+    ++sap->pairTombstones;
+    return kmSAPPushEvent(&sap->removed, &sap->removedCount, &sap->removedCapacity, key);
+}
+
+/* Maps a float onto an unsigned key with the same order */
+static uint32_t kmSAPRadixKey(kmScalar value) {
+    uint32_t bits;
+
+    if(value == 0.0f) {
+        value = 0.0f; /* Sort -0 with +0 */
+    }
+
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+/* LSD radix sort, stable so mins (placed first) stay ahead of equal maxes */
+static void kmSAPRadixSort(kmSAPEndpoint* endpoints, kmSAPEndpoint* scratch, uint32_t count) {
+    int pass;
+
+    for(pass = 0; pass < 4; ++pass) {
+        uint32_t histogram[256];
+        uint32_t sum = 0;
+        int shift = pass * 8;
+        uint32_t i;
+
+        memset(histogram, 0, sizeof(histogram));
+        for(i = 0; i < count; ++i) {
+            ++histogram[(kmSAPRadixKey(endpoints[i].value) >> shift) & 0xFF];
+        }
+
+        for(i = 0; i < 256; ++i) {
+            uint32_t c = histogram[i];
+            histogram[i] = sum;
+            sum += c;
+        }
+
+        for(i = 0; i < count; ++i) {
+            scratch[histogram[(kmSAPRadixKey(endpoints[i].value) >> shift) & 0xFF]++] = endpoints[i];
+        }
+
+        memcpy(endpoints, scratch, sizeof(kmSAPEndpoint) * count);
+    }
+}
+
+static kmBool kmSAPLess(kmSAPEndpoint a, kmSAPEndpoint b) {
+    return a.value < b.value || (a.value == b.value && !ENDPOINT_IS_MAX(a) && ENDPOINT_IS_MAX(b));
+}
+
+/*
+ * Insertion sort of one axis. A min moving left past a max may start an
+ * overlap, a max moving left past a min may end one; the pair is then
+ * checked against the final boxes so each change is reported once.
+ */
+static kmBool kmSAPSortAxis(kmSweepAndPrune* sap, int axis) {
+    kmSAPEndpoint* endpoints = sap->endpoints[axis];
+    uint32_t count = sap->proxyCount * 2;
+    uint32_t j;
+
+    for(j = 1; j < count; ++j) {
+        kmSAPEndpoint key = endpoints[j];
+        uint32_t i = j;
+
+        while(i > 0 && kmSAPLess(key, endpoints[i - 1])) {
+            kmSAPEndpoint other = endpoints[i - 1];
+            uint32_t a = ENDPOINT_PROXY(key);
+            uint32_t b = ENDPOINT_PROXY(other);
+
+            if(!ENDPOINT_IS_MAX(key) && ENDPOINT_IS_MAX(other)) {
+                if(kmSAPOverlaps(&sap->boxes[a], &sap->boxes[b]) && !kmSAPAddPair(sap, a, b)) {
+                    return KM_FALSE;
+                }
+            } else if(ENDPOINT_IS_MAX(key) && !ENDPOINT_IS_MAX(other)) {
+                if(!kmSAPOverlaps(&sap->boxes[a], &sap->boxes[b]) && !kmSAPRemovePair(sap, a, b)) {
+                    return KM_FALSE;
+                }
+            }
+
+            endpoints[i] = other;
+            --i;
+        }
+
+        endpoints[i] = key;
+    }
+
+    return KM_TRUE;
+}
+
+void kmSweepAndPruneInitialize(kmSweepAndPrune* sap) {
+    memset(sap, 0, sizeof(kmSweepAndPrune));
+}
+
+void kmSweepAndPruneRelease(kmSweepAndPrune* sap) {
+    int axis;
+
+    free(sap->boxes);
+    for(axis = 0; axis < 3; ++axis) {
+        free(sap->endpoints[axis]);
+    }
+    free(sap->pairKeys);
+    free(sap->added);
+    free(sap->removed);
+
+    kmSweepAndPruneInitialize(sap);
+}
+
+static kmBool kmSAPBuild(kmSweepAndPrune* sap, uint32_t count, int axisCount) {
+    kmSAPEndpoint* scratch;
+    uint32_t* active;
+    uint32_t* activeIndex;
+    uint32_t activeCount = 0;
+    uint32_t i;
+    int axis;
+
+    sap->axisCount = axisCount;
+    sap->addedCount = 0;
+    sap->removedCount = 0;
+
+    if(!count) {
+        return KM_TRUE;
+    }
+
+    scratch = (kmSAPEndpoint*) malloc(sizeof(kmSAPEndpoint) * count * 2);
+    active = (uint32_t*) malloc(sizeof(uint32_t) * count);
+    activeIndex = (uint32_t*) malloc(sizeof(uint32_t) * count);
+
+    if(!scratch || !active || !activeIndex) {
+        free(scratch);
+        free(active);
+        free(activeIndex);
+        return KM_FALSE;
+    }
+
+    for(axis = 0; axis < axisCount; ++axis) {
+        kmSAPEndpoint* endpoints = sap->endpoints[axis];
+
+        for(i = 0; i < count; ++i) {
+            endpoints[i].value = kmSAPAxisMin(&sap->boxes[i], axis);
+            endpoints[i].data = i << 1;
+            endpoints[count + i].value = kmSAPAxisMax(&sap->boxes[i], axis);
+            endpoints[count + i].data = (i << 1) | 1;
+        }
+
+        kmSAPRadixSort(endpoints, scratch, count * 2);
+    }
+
+    /* Sweep the first axis, testing each new box against the open ones */
+    for(i = 0; i < count * 2; ++i) {
+        kmSAPEndpoint e = sap->endpoints[0][i];
+        uint32_t proxy = ENDPOINT_PROXY(e);
+
+        if(!ENDPOINT_IS_MAX(e)) {
+            uint32_t k;
+            for(k = 0; k < activeCount; ++k) {
+                if(kmSAPOverlaps(&sap->boxes[proxy], &sap->boxes[active[k]]) && !kmSAPAddPair(sap, proxy, active[k])) {
+                    free(scratch);
+                    free(active);
+                    free(activeIndex);
+                    return KM_FALSE;
+                }
+            }
+            activeIndex[proxy] = activeCount;
+            active[activeCount++] = proxy;
+        } else {
+            uint32_t last = active[--activeCount];
+            active[activeIndex[proxy]] = last;
+            activeIndex[last] = activeIndex[proxy];
+        }
+    }
+
+    free(scratch);
+    free(active);
+    free(activeIndex);
+    return KM_TRUE;
+}
+
+/* Sizes the proxy storage and clears the pair set for a fresh build */
+static kmBool kmSAPReset(kmSweepAndPrune* sap, uint32_t count) {
+    int axis;
+
+    if(count > sap->proxyCount) {
+        kmAABB3* boxes = (kmAABB3*) realloc(sap->boxes, sizeof(kmAABB3) * count);
+        if(!boxes) {
+            return KM_FALSE;
+        }
+        sap->boxes = boxes;
+
+        for(axis = 0; axis < 3; ++axis) {
+            kmSAPEndpoint* endpoints = (kmSAPEndpoint*) realloc(sap->endpoints[axis], sizeof(kmSAPEndpoint) * count * 2);
+            if(!endpoints) {
+                return KM_FALSE;
+            }
+            sap->endpoints[axis] = endpoints;
+        }
+    }
+
+    sap->proxyCount = count;
+    sap->pairCount = 0;
+    sap->pairTombstones = 0;
+    if(sap->pairKeys) {
+        memset(sap->pairKeys, 0xFF, sizeof(uint64_t) * sap->pairCapacity);
+    }
+
+    return KM_TRUE;
+}
+
+kmBool kmSweepAndPruneBuild3(kmSweepAndPrune* sap, const kmAABB3* boxes, uint32_t count) {
+    if(!kmSAPReset(sap, count)) {
+        return KM_FALSE;
+    }
+
+    memcpy(sap->boxes, boxes, sizeof(kmAABB3) * count);
+    return kmSAPBuild(sap, count, 3);
+}
+
+kmBool kmSweepAndPruneBuild2(kmSweepAndPrune* sap, const kmAABB2* boxes, uint32_t count) {
+    uint32_t i;
+
+    if(!kmSAPReset(sap, count)) {
+        return KM_FALSE;
+    }
+
+    for(i = 0; i < count; ++i) {
+        kmVec3Fill(&sap->boxes[i].min, boxes[i].min.x, boxes[i].min.y, 0.0f);
+        kmVec3Fill(&sap->boxes[i].max, boxes[i].max.x, boxes[i].max.y, 0.0f);
+    }
+
+    return kmSAPBuild(sap, count, 2);
+}
+
+static kmBool kmSAPUpdate(kmSweepAndPrune* sap) {
+    uint32_t count = sap->proxyCount * 2;
+    uint32_t i;
+    int axis;
+
+    sap->addedCount = 0;
+    sap->removedCount = 0;
+
+    for(axis = 0; axis < sap->axisCount; ++axis) {
+        kmSAPEndpoint* endpoints = sap->endpoints[axis];
+
+        for(i = 0; i < count; ++i) {
+            const kmAABB3* box = &sap->boxes[ENDPOINT_PROXY(endpoints[i])];
+            endpoints[i].value = ENDPOINT_IS_MAX(endpoints[i]) ? kmSAPAxisMax(box, axis) : kmSAPAxisMin(box, axis);
+        }
+    }
+
+    for(axis = 0; axis < sap->axisCount; ++axis) {
+        if(!kmSAPSortAxis(sap, axis)) {
+            return KM_FALSE;
+        }
+    }
+
+    return KM_TRUE;
+}
+
+kmBool kmSweepAndPruneUpdate3(kmSweepAndPrune* sap, const kmAABB3* boxes) {
+    memcpy(sap->boxes, boxes, sizeof(kmAABB3) * sap->proxyCount);
+    return kmSAPUpdate(sap);
+}
+
+kmBool kmSweepAndPruneUpdate2(kmSweepAndPrune* sap, const kmAABB2* boxes) {
+    uint32_t i;
+
+    for(i = 0; i < sap->proxyCount; ++i) {
+        kmVec3Fill(&sap->boxes[i].min, boxes[i].min.x, boxes[i].min.y, 0.0f);
+        kmVec3Fill(&sap->boxes[i].max, boxes[i].max.x, boxes[i].max.y, 0.0f);
+    }
+
+    return kmSAPUpdate(sap);
+}
@@ -208,16 +208,16 @@ kmScalar kmVec2DegreesBetween(const kmVec2* v1, const kmVec2* v2) {
 	 * so we clamp to the -1 - 1 range
 	 */
 
-	if(dot > 1.0) dot = 1.0;
-	if(dot < -1.0) dot = -1.0;
+	if(dot > 1.0f) dot = 1.0f;
+	if(dot < -1.0f) dot = -1.0f;
 
-	return kmRadiansToDegrees(atan2(cross, dot));
+	return kmRadiansToDegrees(atan2f(cross, dot));
 }
 
 kmScalar kmVec2DistanceBetween(const kmVec2* v1, const kmVec2* v2) {
 	kmVec2 diff;
 	kmVec2Subtract(&diff, v2, v1);
-	return fabs(kmVec2Length(&diff));
+	return fabsf(kmVec2Length(&diff));
 }
 
 kmVec2* kmVec2MidPointBetween(kmVec2* pOut, const kmVec2* v1, const kmVec2* v2) {
@@ -318,15 +318,15 @@ kmVec3* kmVec3Zero(kmVec3* pOut) {
  * Code ported from Irrlicht: http://irrlicht.sourceforge.net/
  */
 kmVec3* kmVec3GetHorizontalAngle(kmVec3* pOut, const kmVec3 *pIn) {
-   const kmScalar z1 = sqrt(pIn->x * pIn->x + pIn->z * pIn->z);
+   const kmScalar z1 = sqrtf(pIn->x * pIn->x + pIn->z * pIn->z);
 
-   pOut->y = kmRadiansToDegrees(atan2(pIn->x, pIn->z));
+   pOut->y = kmRadiansToDegrees(atan2f(pIn->x, pIn->z));
    if (pOut->y < 0)
       pOut->y += 360;
    if (pOut->y >= 360)
       pOut->y -= 360;
 
-   pOut->x = kmRadiansToDegrees(atan2(z1, pIn->y)) - 90.0;
+   pOut->x = kmRadiansToDegrees(atan2f(z1, pIn->y)) - 90.0f;
    if (pOut->x < 0)
       pOut->x += 360;
    if (pOut->x >= 360)
@@ -344,14 +344,14 @@ kmVec3* kmVec3RotationToDirection(kmVec3* pOut, const kmVec3* pIn, const kmVec3*
    const kmScalar yr = kmDegreesToRadians(pIn->y);
    const kmScalar zr = kmDegreesToRadians(pIn->z);
 
-   const kmScalar cr = cos(xr);
-   const kmScalar sr = sin(xr);
+   const kmScalar cr = cosf(xr);
+   const kmScalar sr = sinf(xr);
 
-   const kmScalar cp = cos(yr);
-   const kmScalar sp = sin(yr);
+   const kmScalar cp = cosf(yr);
+   const kmScalar sp = sinf(yr);
 
-   const kmScalar cy = cos(zr);
-   const kmScalar sy = sin(zr);
+   const kmScalar cy = cosf(zr);
+   const kmScalar sy = sinf(zr);
 
    const kmScalar srsp = sr*sp;
    const kmScalar crsp = cr*sp;
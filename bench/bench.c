@@ -0,0 +1,652 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Timings for the batch kernels, for comparing changes on one machine.
+ * Build with -DKAZMATH_BUILD_BENCH=ON -DCMAKE_BUILD_TYPE=Release and run
+ * kazmath_bench. Each figure is the best of several runs.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <kazmath/kazmath.h>
+
+#define RUNS 5
+
+/* Grid of GRID_SIZE x GRID_SIZE quads, two triangles each */
+#define GRID_SIZE 256
+#define RAY_COUNT 100000
+
+#define LBVH_MAX_THREADS 16
+
+#define SOUP_TRIANGLES 1024
+#define SOUP_RAYS 2000
+
+#define HASH_GRID_BOXES 100000
+#define QUATERNION_COUNT (1 << 16)
+
+#define BONE_COUNT 64
+#define KEY_COUNT 30
+#define FRAME_COUNT 600
+
+#define VERTEX_COUNT 50000
+
+/* Results are folded in here so no work can be optimized away */
+static volatile kmScalar kmBenchSink;
+
+static double kmBenchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static kmScalar kmBenchRandom(void) {
+    return (kmScalar) rand() / (kmScalar) RAND_MAX;
+}
+
+static void kmBenchRandomQuaternion(kmQuaternion* q) {
+    kmVec3 axis;
+    kmVec3Fill(&axis, kmBenchRandom() - 0.5f, kmBenchRandom() - 0.5f, kmBenchRandom() - 0.5f);
+    kmVec3Normalize(&axis, &axis);
+    kmQuaternionRotationAxisAngle(q, &axis, kmBenchRandom() * kmPI);
+}
+
+static void kmBenchReport(const char* name, double seconds, double count, const char* unit) {
+    printf("%-36s %10.2f ns/%s %12.0f %s/s\n", name, seconds * 1e9 / count, unit, count / seconds, unit);
+}
+
+/* ----------------------------------------------------------------- BVH */
+
+/* Nodes plus the primitive ids the leaves point into, per primitive */
+static void kmBenchReportMemory(const char* name, const kmBVH* bvh, uint32_t count, const char* unit) {
+    double nodes = (double) bvh->nodeCount * sizeof(kmBVHNode) / count;
+    double ids = (double) bvh->primitiveCount * sizeof(uint32_t) / count;
+    printf("%-36s %10.2f bytes/%s (nodes %.2f, ids %.2f)\n", name, nodes + ids, unit, nodes, ids);
+}
+
+static void kmBenchBVH(void) {
+    const uint32_t vertexCount = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+    const uint32_t triangleCount = GRID_SIZE * GRID_SIZE * 2;
+    kmVec3* vertices = (kmVec3*) malloc(sizeof(kmVec3) * vertexCount);
+    uint32_t* indices = (uint32_t*) malloc(sizeof(uint32_t) * 3 * triangleCount);
+    uint32_t* sorted = (uint32_t*) malloc(sizeof(uint32_t) * 3 * triangleCount);
+    kmRay3* rays = (kmRay3*) malloc(sizeof(kmRay3) * RAY_COUNT);
+    double best, start;
+    uint32_t x, z, i;
+    int run;
+    kmBVH bvh;
+
+    /* A rolling heightfield */
+    for(z = 0; z <= GRID_SIZE; ++z) {
+        for(x = 0; x <= GRID_SIZE; ++x) {
+            kmVec3Fill(&vertices[z * (GRID_SIZE + 1) + x], (kmScalar) x,
+                       4.0f * sinf((kmScalar) x * 0.1f) * cosf((kmScalar) z * 0.07f), (kmScalar) z);
+        }
+    }
+
+    for(z = 0; z < GRID_SIZE; ++z) {
+        for(x = 0; x < GRID_SIZE; ++x) {
+            uint32_t v = z * (GRID_SIZE + 1) + x;
+            uint32_t* tri = &indices[(z * GRID_SIZE + x) * 6];
+            tri[0] = v; tri[1] = v + GRID_SIZE + 1; tri[2] = v + 1;
+            tri[3] = v + 1; tri[4] = v + GRID_SIZE + 1; tri[5] = v + GRID_SIZE + 2;
+        }
+    }
+
+    /* Slanted rays from above, long enough to reach the surface */
+    for(i = 0; i < RAY_COUNT; ++i) {
+        kmRay3Fill(&rays[i], kmBenchRandom() * GRID_SIZE, 20.0f, kmBenchRandom() * GRID_SIZE,
+                   (kmBenchRandom() - 0.5f) * 20.0f, -40.0f, (kmBenchRandom() - 0.5f) * 20.0f);
+    }
+
+    best = 1e30;
+    for(run = 0; run < RUNS; ++run) {
+        for(i = 0; i < 3 * triangleCount; ++i) sorted[i] = indices[i];
+        start = kmBenchNow();
+        kmBVHBuildTriangles(&bvh, vertices, sorted, triangleCount);
+        best = fmin(best, kmBenchNow() - start);
+        if(run + 1 < RUNS) kmBVHRelease(&bvh);
+    }
+    kmBenchReport("BVH SAH build", best, triangleCount, "tri");
+    kmBenchReportMemory("BVH SAH memory", &bvh, triangleCount, "tri");
+
+    best = 1e30;
+    for(run = 0; run < RUNS; ++run) {
+        uint32_t hits = 0;
+        kmBVHHit hit;
+        start = kmBenchNow();
+        for(i = 0; i < RAY_COUNT; ++i) {
+            hits += kmBVHIntersectTriangles(&bvh, &rays[i], vertices, sorted, &hit);
+        }
+        best = fmin(best, kmBenchNow() - start);
+        kmBenchSink = (kmScalar) hits;
+    }
+    kmBenchReport("BVH closest hit", best, RAY_COUNT, "ray");
+
+    best = 1e30;
+    for(run = 0; run < RUNS; ++run) {
+        uint32_t hits = 0;
+        start = kmBenchNow();
+        for(i = 0; i < RAY_COUNT; ++i) {
+            hits += kmBVHIntersectTrianglesAny(&bvh, &rays[i], vertices, sorted);
+        }
+        best = fmin(best, kmBenchNow() - start);
+        kmBenchSink = (kmScalar) hits;
+    }
+    kmBenchReport("BVH occluded", best, RAY_COUNT, "ray");
+    kmBVHRelease(&bvh);
+
+    free(vertices);
+    free(indices);
+    free(sorted);
+    free(rays);
+}
+
+/* ---------------------------------------------------------------- LBVH */
+
+typedef struct kmBenchLBVHWorker {
+    const kmLBVHBuilder* builder;
+    uint32_t first;
+    uint32_t step;
+} kmBenchLBVHWorker;
+
+static void* kmBenchLBVHRun(void* context) {
+    const kmBenchLBVHWorker* worker = (const kmBenchLBVHWorker*) context;
+    uint32_t task;
+
+    for(task = worker->first; task < worker->builder->taskCount; task += worker->step) {
+        kmLBVHBuildTask(worker->builder, task);
+    }
+    return NULL;
+}
+
+/* The whole build, sort included, with the tasks spread over threadCount threads */
+static double kmBenchLBVHBuild(kmBVH* bvh, const kmAABB3* bounds, uint32_t count, uint32_t threadCount) {
+    kmBenchLBVHWorker workers[LBVH_MAX_THREADS];
+    pthread_t threads[LBVH_MAX_THREADS];
+    int started[LBVH_MAX_THREADS];
+    kmLBVHBuilder builder;
+    double start = kmBenchNow();
+    uint32_t i;
+
+    if(!kmLBVHBegin(&builder, bvh, bounds, count, KM_LBVH_MAX_TASKS)) {
+        return -1.0;
+    }
+
+    /* The calling thread takes the first share of the tasks itself, and
+     * the share of any thread which could not be started */
+    for(i = 0; i < threadCount; ++i) {
+        workers[i].builder = &builder;
+        workers[i].first = i;
+        workers[i].step = threadCount;
+        started[i] = i > 0 && pthread_create(&threads[i], NULL, kmBenchLBVHRun, &workers[i]) == 0;
+    }
+    for(i = 0; i < threadCount; ++i) {
+        if(started[i]) {
+            continue;
+        }
+        kmBenchLBVHRun(&workers[i]);
+    }
+    for(i = 1; i < threadCount; ++i) {
+        if(started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    kmLBVHEnd(&builder);
+    return kmBenchNow() - start;
+}
+
+static void kmBenchLBVH(void) {
+    static const uint32_t counts[4] = { 100000, 250000, 500000, 1000000 };
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t maxThreads = cpus < 1 ? 1 : (cpus > LBVH_MAX_THREADS ? LBVH_MAX_THREADS : (uint32_t) cpus);
+    kmAABB3* bounds = (kmAABB3*) malloc(sizeof(kmAABB3) * counts[3]);
+    uint32_t c, i, threads;
+    int run;
+    kmBVH bvh;
+
+    /* Small boxes scattered through a cube, like the bounds of a particle system */
+    for(i = 0; i < counts[3]; ++i) {
+        kmVec3 p;
+        kmScalar r = 0.01f + kmBenchRandom() * 0.05f;
+        kmVec3Fill(&p, kmBenchRandom() * 100.0f, kmBenchRandom() * 100.0f, kmBenchRandom() * 100.0f);
+        kmVec3Fill(&bounds[i].min, p.x - r, p.y - r, p.z - r);
+        kmVec3Fill(&bounds[i].max, p.x + r, p.y + r, p.z + r);
+    }
+
+    for(c = 0; c < 4; ++c) {
+        for(threads = 1; threads <= maxThreads; threads *= 2) {
+            char name[64];
+            double best = 1e30;
+
+            for(run = 0; run < RUNS; ++run) {
+                double seconds = kmBenchLBVHBuild(&bvh, bounds, counts[c], threads);
+                if(seconds < 0.0) {
+                    printf("LBVH build of %u boxes ran out of memory\n", counts[c]);
+                    free(bounds);
+                    return;
+                }
+                best = fmin(best, seconds);
+                if(run + 1 < RUNS) kmBVHRelease(&bvh);
+            }
+
+            sprintf(name, "LBVH build %uk, %u thread%s", counts[c] / 1000, threads, threads == 1 ? "" : "s");
+            kmBenchReport(name, best, counts[c], "box");
+            if(threads * 2 > maxThreads) {
+                sprintf(name, "LBVH memory %uk", counts[c] / 1000);
+                kmBenchReportMemory(name, &bvh, counts[c], "box");
+            }
+            kmBVHRelease(&bvh);
+        }
+    }
+
+    free(bounds);
+}
+
+/* ----------------------------------------------------------- Occlusion */
+
+static void kmBenchOcclusion(void) {
+    kmVec3* vertices = (kmVec3*) malloc(sizeof(kmVec3) * 3 * SOUP_TRIANGLES);
+    kmScalar* streams = (kmScalar*) malloc(sizeof(kmScalar) * 9 * SOUP_TRIANGLES);
+    kmRay3* rays = (kmRay3*) malloc(sizeof(kmRay3) * SOUP_RAYS);
+    kmScalar* lengths = (kmScalar*) malloc(sizeof(kmScalar) * SOUP_RAYS);
+    kmTriangle3SoA soa;
+    double best, start;
+    uint32_t i, j;
+    int run, kernel;
+
+    soa.v0x = streams; soa.v0y = streams + SOUP_TRIANGLES; soa.v0z = streams + SOUP_TRIANGLES * 2;
+    soa.e1x = streams + SOUP_TRIANGLES * 3; soa.e1y = streams + SOUP_TRIANGLES * 4; soa.e1z = streams + SOUP_TRIANGLES * 5;
+    soa.e2x = streams + SOUP_TRIANGLES * 6; soa.e2y = streams + SOUP_TRIANGLES * 7; soa.e2z = streams + SOUP_TRIANGLES * 8;
+
+    /* A soup of unit sized triangles in a 20 unit cube */
+    for(i = 0; i < SOUP_TRIANGLES; ++i) {
+        kmVec3 c;
+        kmVec3Fill(&c, kmBenchRandom() * 20.0f, kmBenchRandom() * 20.0f, kmBenchRandom() * 20.0f);
+        for(j = 0; j < 3; ++j) {
+            kmVec3Fill(&vertices[i * 3 + j], c.x + kmBenchRandom() - 0.5f, c.y + kmBenchRandom() - 0.5f,
+                       c.z + kmBenchRandom() - 0.5f);
+        }
+    }
+    kmTriangle3SoAFill(&soa, vertices, NULL, SOUP_TRIANGLES);
+
+    /* Visibility segments between random points in the cube */
+    for(i = 0; i < SOUP_RAYS; ++i) {
+        kmVec3 from, to, dir;
+        kmVec3Fill(&from, kmBenchRandom() * 20.0f, kmBenchRandom() * 20.0f, kmBenchRandom() * 20.0f);
+        kmVec3Fill(&to, kmBenchRandom() * 20.0f, kmBenchRandom() * 20.0f, kmBenchRandom() * 20.0f);
+        kmVec3Subtract(&dir, &to, &from);
+        lengths[i] = kmVec3Length(&dir);
+        kmRay3FromPointAndDirection(&rays[i], &from, &dir);
+    }
+
+    for(kernel = 0; kernel < 3; ++kernel) {
+        static const char* names[3] = {
+            "Triangle array closest hit", "Triangle array occluded", "Triangle occluded scalar"
+        };
+
+        best = 1e30;
+        for(run = 0; run < RUNS; ++run) {
+            uint32_t hits = 0;
+            start = kmBenchNow();
+            for(i = 0; i < SOUP_RAYS; ++i) {
+                switch(kernel) {
+                    case 0:
+                        hits += kmRay3IntersectTriangleArray(&rays[i], &soa, SOUP_TRIANGLES, KM_RAY3_DOUBLE_SIDED,
+                                                             NULL, NULL, NULL, NULL, NULL, NULL);
+                        break;
+                    case 1:
+                        hits += kmRay3OccludedTriangleArray(&rays[i], &soa, SOUP_TRIANGLES, KM_RAY3_DOUBLE_SIDED,
+                                                            lengths[i]);
+                        break;
+                    default:
+                        for(j = 0; j < SOUP_TRIANGLES; ++j) {
+                            if(kmRay3OccludedTriangle(&rays[i], &vertices[j * 3], &vertices[j * 3 + 1],
+                                                      &vertices[j * 3 + 2], KM_RAY3_DOUBLE_SIDED, lengths[i])) {
+                                ++hits;
+                                break;
+                            }
+                        }
+                        break;
+                }
+            }
+            best = fmin(best, kmBenchNow() - start);
+            kmBenchSink = (kmScalar) hits;
+        }
+        kmBenchReport(names[kernel], best, SOUP_RAYS, "ray");
+    }
+
+    free(vertices);
+    free(streams);
+    free(rays);
+    free(lengths);
+}
+
+/* ----------------------------------------------------------- Hash grid */
+
+static kmBool kmBenchCountPair(void* context, uint32_t a, uint32_t b) {
+    (void) a;
+    (void) b;
+    ++*(uint32_t*) context;
+    return KM_TRUE;
+}
+
+static void kmBenchHashGrid(void) {
+    kmAABB3* boxes = (kmAABB3*) malloc(sizeof(kmAABB3) * HASH_GRID_BOXES);
+    double best, start;
+    kmHashGrid grid;
+    uint32_t i;
+    int run;
+
+    /* Roughly one box per cell with some overlap between neighbours */
+    for(i = 0; i < HASH_GRID_BOXES; ++i) {
+        kmVec3 c;
+        kmScalar r = 0.2f + kmBenchRandom() * 0.4f;
+        kmVec3Fill(&c, kmBenchRandom() * 46.0f, kmBenchRandom() * 46.0f, kmBenchRandom() * 46.0f);
+        kmVec3Fill(&boxes[i].min, c.x - r, c.y - r, c.z - r);
+        kmVec3Fill(&boxes[i].max, c.x + r, c.y + r, c.z + r);
+    }
+
+    kmHashGridInitialize(&grid, 1.0f);
+
+    best = 1e30;
+    for(run = 0; run < RUNS; ++run) {
+        start = kmBenchNow();
+        kmHashGridBuild(&grid, boxes, HASH_GRID_BOXES);
+        best = fmin(best, kmBenchNow() - start);
+    }
+    kmBenchReport("Hash grid build", best, HASH_GRID_BOXES, "box");
+
+    best = 1e30;
+    for(run = 0; run < RUNS; ++run) {
+        uint32_t pairs = 0;
+        start = kmBenchNow();
+        kmHashGridQueryPairs(&grid, kmBenchCountPair, &pairs);
+        best = fmin(best, kmBenchNow() - start);
+        kmBenchSink = (kmScalar) pairs;
+    }
+    kmBenchReport("Hash grid pairs", best, HASH_GRID_BOXES, "box");
+
+    kmHashGridRelease(&grid);
+    free(boxes);
+}
+
+/* --------------------------------------------------------------- Slerp */
+
+static void kmBenchSlerp(void) {
+    kmQuaternion* a = (kmQuaternion*) malloc(sizeof(kmQuaternion) * QUATERNION_COUNT);
+    kmQuaternion* b = (kmQuaternion*) malloc(sizeof(kmQuaternion) * QUATERNION_COUNT);
+    kmQuaternion* out = (kmQuaternion*) malloc(sizeof(kmQuaternion) * QUATERNION_COUNT);
+    kmScalar* streams = (kmScalar*) malloc(sizeof(kmScalar) * QUATERNION_COUNT * 13);
+    kmQuaternionSoA soaA, soaB, soaOut;
+    kmScalar* t = streams + QUATERNION_COUNT * 12;
+    double best, start;
+    int run, kernel;
+    size_t i;
+
+    soaA.x = streams; soaA.y = streams + QUATERNION_COUNT;
+    soaA.z = streams + QUATERNION_COUNT * 2; soaA.w = streams + QUATERNION_COUNT * 3;
+    soaB.x = streams + QUATERNION_COUNT * 4; soaB.y = streams + QUATERNION_COUNT * 5;
+    soaB.z = streams + QUATERNION_COUNT * 6; soaB.w = streams + QUATERNION_COUNT * 7;
+    soaOut.x = streams + QUATERNION_COUNT * 8; soaOut.y = streams + QUATERNION_COUNT * 9;
+    soaOut.z = streams + QUATERNION_COUNT * 10; soaOut.w = streams + QUATERNION_COUNT * 11;
+
+    for(i = 0; i < QUATERNION_COUNT; ++i) {
+        kmBenchRandomQuaternion(&a[i]);
+        kmBenchRandomQuaternion(&b[i]);
+        if(kmQuaternionDot(&a[i], &b[i]) < 0.0f) {
+            kmQuaternionScale(&b[i], &b[i], -1.0f);
+        }
+        soaA.x[i] = a[i].x; soaA.y[i] = a[i].y; soaA.z[i] = a[i].z; soaA.w[i] = a[i].w;
+        soaB.x[i] = b[i].x; soaB.y[i] = b[i].y; soaB.z[i] = b[i].z; soaB.w[i] = b[i].w;
+        t[i] = kmBenchRandom();
+    }
+
+    for(kernel = 0; kernel < 5; ++kernel) {
+        static const char* names[5] = {
+            "Slerp scalar", "SlerpFast scalar", "SlerpArray SoA", "SlerpFastArray SoA", "NlerpArray SoA"
+        };
+
+        best = 1e30;
+        for(run = 0; run < RUNS; ++run) {
+            start = kmBenchNow();
+            switch(kernel) {
+                case 0:
+                    for(i = 0; i < QUATERNION_COUNT; ++i) kmQuaternionSlerp(&out[i], &a[i], &b[i], t[i]);
+                    break;
+                case 1:
+                    for(i = 0; i < QUATERNION_COUNT; ++i) kmQuaternionSlerpFast(&out[i], &a[i], &b[i], t[i]);
+                    break;
+                case 2:
+                    kmQuaternionSlerpArray(&soaOut, &soaA, &soaB, t, 0.0f, QUATERNION_COUNT);
+                    break;
+                case 3:
+                    kmQuaternionSlerpFastArray(&soaOut, &soaA, &soaB, t, 0.0f, QUATERNION_COUNT);
+                    break;
+                default:
+                    kmQuaternionNlerpArray(&soaOut, &soaA, &soaB, t, 0.0f, QUATERNION_COUNT);
+                    break;
+            }
+            best = fmin(best, kmBenchNow() - start);
+        }
+        kmBenchSink = out[QUATERNION_COUNT / 2].w + soaOut.w[QUATERNION_COUNT / 2];
+        kmBenchReport(names[kernel], best, QUATERNION_COUNT, "quat");
+    }
+
+    free(a);
+    free(b);
+    free(out);
+    free(streams);
+}
+
+/* ------------------------------------------------------------- Sampler */
+
+static void kmBenchSampler(void) {
+    const uint32_t channelCount = BONE_COUNT * 3;
+    const uint32_t keys = channelCount * KEY_COUNT;
+    kmAnimChannel* channels = (kmAnimChannel*) malloc(sizeof(kmAnimChannel) * channelCount);
+    kmScalar* values = (kmScalar*) malloc(sizeof(kmScalar) * keys * 5);
+    kmVec3* translations = (kmVec3*) malloc(sizeof(kmVec3) * BONE_COUNT);
+    kmQuaternion* rotations = (kmQuaternion*) malloc(sizeof(kmQuaternion) * BONE_COUNT);
+    kmVec3* scales = (kmVec3*) malloc(sizeof(kmVec3) * BONE_COUNT);
+    kmAnimSampler sampler;
+    kmAnimClip clip;
+    double best, start;
+    uint32_t c, k;
+    int run, frame;
+
+    clip.duration = 1.0f;
+    clip.boneCount = BONE_COUNT;
+    clip.channelCount = channelCount;
+    clip.channels = channels;
+    clip.times = values;
+    clip.x = values + keys;
+    clip.y = values + keys * 2;
+    clip.z = values + keys * 3;
+    clip.w = values + keys * 4;
+
+    for(c = 0; c < channelCount; ++c) {
+        channels[c].bone = c / 3;
+        channels[c].type = (c % 3 == 0) ? KM_ANIM_TRANSLATION : (c % 3 == 1 ? KM_ANIM_ROTATION : KM_ANIM_SCALE);
+        channels[c].firstKey = c * KEY_COUNT;
+        channels[c].keyCount = KEY_COUNT;
+
+        for(k = 0; k < KEY_COUNT; ++k) {
+            uint32_t key = c * KEY_COUNT + k;
+            kmQuaternion q;
+
+            kmBenchRandomQuaternion(&q);
+            values[key] = (kmScalar) k / (kmScalar) KEY_COUNT;
+            values[keys + key] = q.x;
+            values[keys * 2 + key] = q.y;
+            values[keys * 3 + key] = q.z;
+            values[keys * 4 + key] = q.w;
+        }
+    }
+
+    kmAnimSamplerInitialize(&sampler, &clip);
+
+    /* Playing forwards at 60Hz, looping through the clip ten times */
+    best = 1e30;
+    for(run = 0; run < RUNS; ++run) {
+        kmAnimSamplerReset(&sampler);
+        start = kmBenchNow();
+        for(frame = 0; frame < FRAME_COUNT; ++frame) {
+            kmAnimSamplerSample(&sampler, (kmScalar) frame / 60.0f, KM_TRUE, translations, rotations, scales);
+        }
+        best = fmin(best, kmBenchNow() - start);
+    }
+    kmBenchSink = rotations[BONE_COUNT / 2].w;
+    kmBenchReport("Sampler per bone, forwards", best, (double) FRAME_COUNT * BONE_COUNT, "bone");
+
+    /* Random seeks, which take the binary search */
+    best = 1e30;
+    for(run = 0; run < RUNS; ++run) {
+        start = kmBenchNow();
+        for(frame = 0; frame < FRAME_COUNT; ++frame) {
+            kmAnimSamplerSample(&sampler, (kmScalar) ((frame * 7919) % FRAME_COUNT) / (kmScalar) FRAME_COUNT,
+                                KM_TRUE, translations, rotations, scales);
+        }
+        best = fmin(best, kmBenchNow() - start);
+    }
+    kmBenchSink = rotations[BONE_COUNT / 2].w;
+    kmBenchReport("Sampler per bone, seeking", best, (double) FRAME_COUNT * BONE_COUNT, "bone");
+
+    kmAnimSamplerRelease(&sampler);
+    free(channels);
+    free(values);
+    free(translations);
+    free(rotations);
+    free(scales);
+}
+
+/* ------------------------------------------------------------ Skinning */
+
+typedef struct kmBenchVertex {
+    kmScalar position[3];
+    kmScalar normal[3];
+    kmUchar indices[4];
+    kmScalar weights[4];
+} kmBenchVertex;
+
+static void kmBenchSkinning(void) {
+    kmBenchVertex* vertices = (kmBenchVertex*) malloc(sizeof(kmBenchVertex) * VERTEX_COUNT);
+    kmScalar* out = (kmScalar*) malloc(sizeof(kmScalar) * 6 * VERTEX_COUNT);
+    kmMat4 matrices[BONE_COUNT];
+    kmSkinMat3x4 matrices3x4[BONE_COUNT];
+    kmDualQuaternion dualQuaternions[BONE_COUNT];
+    kmSkinVertices skin;
+    double best, start;
+    int run, kernel, j;
+    uint32_t i;
+
+    for(i = 0; i < BONE_COUNT; ++i) {
+        kmQuaternion q;
+        kmVec3 t, s;
+
+        kmBenchRandomQuaternion(&q);
+        kmVec3Fill(&t, kmBenchRandom(), kmBenchRandom(), kmBenchRandom());
+        kmVec3Fill(&s, 1.0f, 1.0f, 1.0f);
+        kmMat4FromTRS(&matrices[i], &t, &q, &s);
+        kmDualQuaternionFromRotationTranslation(&dualQuaternions[i], &q, &t);
+    }
+    kmSkinMat3x4FromMat4(matrices3x4, matrices, BONE_COUNT);
+
+    for(i = 0; i < VERTEX_COUNT; ++i) {
+        kmScalar sum = 0.0f;
+        for(j = 0; j < 3; ++j) {
+            vertices[i].position[j] = kmBenchRandom();
+            vertices[i].normal[j] = j == 1 ? 1.0f : 0.0f;
+        }
+        for(j = 0; j < 4; ++j) {
+            vertices[i].indices[j] = (kmUchar) (rand() % BONE_COUNT);
+            vertices[i].weights[j] = kmBenchRandom();
+            sum += vertices[i].weights[j];
+        }
+        for(j = 0; j < 4; ++j) {
+            vertices[i].weights[j] /= sum;
+        }
+    }
+
+    skin.positions = vertices[0].position;
+    skin.positionStride = sizeof(kmBenchVertex);
+    skin.normals = vertices[0].normal;
+    skin.normalStride = sizeof(kmBenchVertex);
+    skin.indices = vertices[0].indices;
+    skin.indexStride = sizeof(kmBenchVertex);
+    skin.indexType = KM_SKIN_INDEX_U8;
+    skin.weights = vertices[0].weights;
+    skin.weightStride = sizeof(kmBenchVertex);
+    skin.weightType = KM_SKIN_WEIGHT_FLOAT;
+    skin.influences = 4;
+
+    for(kernel = 0; kernel < 3; ++kernel) {
+        static const char* names[3] = { "Linear blend skinning", "Linear blend skinning 3x4", "Dual quaternion skinning" };
+
+        best = 1e30;
+        for(run = 0; run < RUNS; ++run) {
+            start = kmBenchNow();
+            switch(kernel) {
+                case 0:
+                    kmSkinLinearBlend(out, sizeof(kmScalar) * 6, out + 3, sizeof(kmScalar) * 6, &skin, matrices, VERTEX_COUNT);
+                    break;
+                case 1:
+                    kmSkinLinearBlend3x4(out, sizeof(kmScalar) * 6, out + 3, sizeof(kmScalar) * 6, &skin, matrices3x4, VERTEX_COUNT);
+                    break;
+                default:
+                    kmSkinDualQuaternion(out, sizeof(kmScalar) * 6, out + 3, sizeof(kmScalar) * 6, &skin, dualQuaternions, VERTEX_COUNT);
+                    break;
+            }
+            best = fmin(best, kmBenchNow() - start);
+        }
+        kmBenchSink = out[VERTEX_COUNT * 3];
+        kmBenchReport(names[kernel], best, VERTEX_COUNT, "vert");
+    }
+
+    free(vertices);
+    free(out);
+}
+
+int main(void) {
+    srand(1);
+
+    kmBenchBVH();
+    kmBenchLBVH();
+    kmBenchOcclusion();
+    kmBenchHashGrid();
+    kmBenchSlerp();
+    kmBenchSampler();
+    kmBenchSkinning();
+
+    return 0;
+}
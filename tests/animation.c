@@ -0,0 +1,145 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+
+#include <kazmath/kazmath.h>
+
+#include "test.h"
+
+/*
+ * Bone 0: translation keys x = 0, 10, 20 at 0, 1, 2 and rotation keys
+ * identity and 90 degrees about z at 0 and 2.
+ * Bone 1: translation keys x = 0, 10 at 1 and 3, away from the clip ends.
+ */
+static const kmAnimChannel channels[] = {
+    { 0, KM_ANIM_TRANSLATION, 0, 3 },
+    { 0, KM_ANIM_ROTATION, 3, 2 },
+    { 1, KM_ANIM_TRANSLATION, 5, 2 }
+};
+
+static const kmScalar times[] = { 0.0f, 1.0f, 2.0f, 0.0f, 2.0f, 1.0f, 3.0f };
+static const kmScalar xs[] = { 0.0f, 10.0f, 20.0f, 0.0f, 0.0f, 0.0f, 10.0f };
+static const kmScalar ys[] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+static const kmScalar zs[] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.70710678f, 0.0f, 0.0f };
+static const kmScalar ws[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.70710678f, 0.0f, 0.0f };
+
+static kmVec3 translations[2];
+static kmQuaternion rotations[2];
+static kmVec3 scales[2];
+
+static void sample(kmAnimSampler* sampler, kmScalar time, kmBool loop) {
+    kmAnimSamplerSample(sampler, time, loop, translations, rotations, scales);
+}
+
+/* Rotation angle of bone 0 about z, in degrees */
+static kmScalar angle(void) {
+    return kmRadiansToDegrees(2.0f * atan2f(rotations[0].z, rotations[0].w));
+}
+
+/* Bone 0's x as a function of wrapped time, for a looping clip */
+static kmScalar expectedLoopX(kmScalar time) {
+    time = fmodf(time, 4.0f);
+    if(time < 0.0f) {
+        time += 4.0f;
+    }
+    return (time <= 2.0f) ? time * 10.0f : 20.0f * (4.0f - time) / 2.0f;
+}
+
+int main(void) {
+    kmAnimClip clip = { 4.0f, 2, 3, channels, times, xs, ys, zs, ws };
+    kmAnimSampler sampler;
+    kmScalar time;
+
+    KM_CHECK(kmAnimSamplerInitialize(&sampler, &clip));
+
+    /* Forward playback inside the keys */
+    sample(&sampler, 0.5f, KM_FALSE);
+    KM_CHECK_NEAR(translations[0].x, 5.0f, 1e-5f);
+    KM_CHECK_NEAR(angle(), 22.5f, 1e-2f);
+    sample(&sampler, 1.5f, KM_FALSE);
+    KM_CHECK_NEAR(translations[0].x, 15.0f, 1e-5f);
+    KM_CHECK(sampler.cursors[0] == 1);
+
+    /* Clamped playback holds the end keys */
+    sample(&sampler, 3.0f, KM_FALSE);
+    KM_CHECK_NEAR(translations[0].x, 20.0f, 1e-5f);
+    KM_CHECK_NEAR(angle(), 90.0f, 1e-2f);
+    sample(&sampler, -1.0f, KM_FALSE);
+    KM_CHECK_NEAR(translations[0].x, 0.0f, 1e-5f);
+    KM_CHECK_NEAR(translations[1].x, 0.0f, 1e-5f);
+
+    /* Looping blends from the last key back to the first */
+    sample(&sampler, 3.0f, KM_TRUE);
+    KM_CHECK_NEAR(translations[0].x, 10.0f, 1e-5f);
+    KM_CHECK_NEAR(angle(), 45.0f, 1e-2f);
+    KM_CHECK_NEAR(translations[1].x, 10.0f, 1e-5f);
+    sample(&sampler, 3.5f, KM_TRUE);
+    KM_CHECK_NEAR(translations[1].x, 7.5f, 1e-5f);
+
+    /* ... and before a first key that is not at the start */
+    sample(&sampler, 0.0f, KM_TRUE);
+    KM_CHECK_NEAR(translations[1].x, 5.0f, 1e-5f);
+    sample(&sampler, 0.5f, KM_TRUE);
+    KM_CHECK_NEAR(translations[1].x, 2.5f, 1e-5f);
+
+    /* Past the end wraps around */
+    sample(&sampler, 4.5f, KM_TRUE);
+    KM_CHECK_NEAR(translations[0].x, 5.0f, 1e-4f);
+    sample(&sampler, 11.0f, KM_TRUE);
+    KM_CHECK_NEAR(translations[0].x, 10.0f, 1e-4f);
+
+    /* Negative time wraps from the end */
+    sample(&sampler, -1.0f, KM_TRUE);
+    KM_CHECK_NEAR(translations[0].x, 10.0f, 1e-4f);
+    sample(&sampler, -3.5f, KM_TRUE);
+    KM_CHECK_NEAR(translations[0].x, 5.0f, 1e-4f);
+
+    /* A backward seek after the cursor has moved takes the binary search */
+    sample(&sampler, 2.5f, KM_FALSE);
+    KM_CHECK(sampler.cursors[0] == 2);
+    sample(&sampler, 0.25f, KM_FALSE);
+    KM_CHECK(sampler.cursors[0] == 0);
+    KM_CHECK_NEAR(translations[0].x, 2.5f, 1e-5f);
+    sample(&sampler, 1.0f, KM_FALSE);
+    KM_CHECK(sampler.cursors[0] == 1);
+    KM_CHECK_NEAR(translations[0].x, 10.0f, 1e-5f);
+
+    /* Reset moves every cursor back to the first key */
+    sample(&sampler, 2.5f, KM_FALSE);
+    kmAnimSamplerReset(&sampler);
+    KM_CHECK(sampler.cursors[0] == 0 && sampler.cursors[1] == 0 && sampler.cursors[2] == 0);
+    sample(&sampler, 1.5f, KM_FALSE);
+    KM_CHECK_NEAR(translations[0].x, 15.0f, 1e-5f);
+
+    /* Continuous looping playback matches the closed form */
+    for(time = -6.0f; time < 10.0f; time += 0.07f) {
+        sample(&sampler, time, KM_TRUE);
+        KM_CHECK_NEAR(translations[0].x, expectedLoopX(time), 1e-3f);
+    }
+
+    kmAnimSamplerRelease(&sampler);
+    return KM_TEST_RESULT();
+}
@@ -0,0 +1,113 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kazmath/kazmath.h>
+
+#include "test.h"
+
+#define PRIMITIVE_COUNT 600
+
+static uint32_t depthOf(const kmBVH* bvh, uint32_t index) {
+    const kmBVHNode* node = &bvh->nodes[index];
+    uint32_t left, right;
+
+    if(node->count) {
+        return 0;
+    }
+
+    left = depthOf(bvh, index + 1);
+    right = depthOf(bvh, node->offset);
+    return 1 + (left > right ? left : right);
+}
+
+typedef struct Visits {
+    uint32_t counts[PRIMITIVE_COUNT];
+    uint32_t total;
+} Visits;
+
+static kmBool visit(void* context, uint32_t primitive) {
+    Visits* visits = (Visits*) context;
+    ++visits->counts[primitive];
+    ++visits->total;
+    return KM_TRUE;
+}
+
+/* Every primitive is reported once by a query covering them all, and a
+ * query at each primitive's box finds it */
+static void checkQueries(const kmBVH* bvh, const kmAABB3* bounds) {
+    kmAABB3 everything;
+    Visits visits;
+    uint32_t i;
+
+    everything = bounds[0];
+    for(i = 1; i < PRIMITIVE_COUNT; ++i) {
+        kmAABB3ExpandToContain(&everything, &everything, &bounds[i]);
+    }
+
+    memset(&visits, 0, sizeof(visits));
+    kmBVHQueryAABB3(bvh, &everything, visit, &visits);
+    KM_CHECK(visits.total == PRIMITIVE_COUNT);
+    for(i = 0; i < PRIMITIVE_COUNT; ++i) {
+        KM_CHECK(visits.counts[i] == 1);
+    }
+
+    for(i = 0; i < PRIMITIVE_COUNT; ++i) {
+        memset(&visits, 0, sizeof(visits));
+        kmBVHQueryAABB3(bvh, &bounds[i], visit, &visits);
+        KM_CHECK(visits.counts[i] == 1);
+    }
+}
+
+int main(void) {
+    kmAABB3 bounds[PRIMITIVE_COUNT];
+    kmBVH bvh;
+    uint32_t i;
+
+    /* Geometrically spaced boxes make each SAH split peel off only the
+     * furthest few, so the tree runs past the SAH depth limit */
+    for(i = 0; i < PRIMITIVE_COUNT; ++i) {
+        kmScalar x = powf(1.25f, (kmScalar) (i / 2));
+        kmVec3Fill(&bounds[i].min, x, (kmScalar) (i & 1), 0.0f);
+        kmVec3Fill(&bounds[i].max, x * 1.1f, (kmScalar) (i & 1) + 0.5f, 0.5f);
+    }
+
+    KM_CHECK(kmBVHBuild(&bvh, bounds, PRIMITIVE_COUNT));
+    printf("SAH depth %u\n", depthOf(&bvh, 0));
+    KM_CHECK(depthOf(&bvh, 0) + 1 <= 64);
+    checkQueries(&bvh, bounds);
+    kmBVHRelease(&bvh);
+
+    KM_CHECK(kmBVHBuildLinear(&bvh, bounds, PRIMITIVE_COUNT));
+    printf("LBVH depth %u\n", depthOf(&bvh, 0));
+    KM_CHECK(depthOf(&bvh, 0) + 1 <= 64);
+    checkQueries(&bvh, bounds);
+    kmBVHRelease(&bvh);
+
+    return KM_TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kazmath/kazmath.h>
+
+#include "test.h"
+
+#define BOX_COUNT 300
+
+typedef struct Visits {
+    uint32_t counts[BOX_COUNT];
+    uint32_t total;
+} Visits;
+
+static kmBool visit(void* context, uint32_t entity) {
+    Visits* visits = (Visits*) context;
+    ++visits->counts[entity];
+    ++visits->total;
+    return KM_TRUE;
+}
+
+static kmBool overlaps(const kmAABB3* a, const kmAABB3* b) {
+    return a->min.x <= b->max.x && b->min.x <= a->max.x &&
+           a->min.y <= b->max.y && b->min.y <= a->max.y &&
+           a->min.z <= b->max.z && b->min.z <= a->max.z;
+}
+
+/* Each box overlapping query is reported exactly once, and no other */
+static uint32_t checkQuery(const kmHashGrid* grid, const kmAABB3* boxes, const kmAABB3* query) {
+    uint32_t hits = 0;
+    Visits visits;
+    uint32_t i;
+
+    memset(&visits, 0, sizeof(visits));
+    kmHashGridQueryAABB3(grid, query, visit, &visits);
+
+    for(i = 0; i < BOX_COUNT; ++i) {
+        KM_CHECK(visits.counts[i] == (overlaps(&boxes[i], query) ? 1u : 0u));
+        hits += visits.counts[i];
+    }
+
+    return hits;
+}
+
+int main(void) {
+    kmAABB3 boxes[BOX_COUNT];
+    kmAABB3 query;
+    kmHashGrid grid;
+    Visits visits;
+    kmVec3 centre;
+    uint32_t i;
+
+    srand(7);
+
+    /* Boxes of up to two cells across, so most span several cells */
+    for(i = 0; i < BOX_COUNT; ++i) {
+        kmScalar x = (kmScalar) rand() / (kmScalar) RAND_MAX * 20.0f - 10.0f;
+        kmScalar y = (kmScalar) rand() / (kmScalar) RAND_MAX * 20.0f - 10.0f;
+        kmScalar z = (kmScalar) rand() / (kmScalar) RAND_MAX * 20.0f - 10.0f;
+        kmScalar size = (kmScalar) rand() / (kmScalar) RAND_MAX * 2.0f;
+        kmVec3Fill(&boxes[i].min, x, y, z);
+        kmVec3Fill(&boxes[i].max, x + size, y + size, z + size);
+    }
+
+    kmHashGridInitialize(&grid, 1.0f);
+    KM_CHECK(kmHashGridBuild(&grid, boxes, BOX_COUNT));
+
+    /* A region small enough to be walked cell by cell */
+    kmVec3Fill(&query.min, -3.0f, -2.0f, -4.0f);
+    kmVec3Fill(&query.max, 2.5f, 3.0f, 1.0f);
+    KM_CHECK(checkQuery(&grid, boxes, &query) > 0);
+
+    /* Regions too big to walk, which scan the cell table instead */
+    kmVec3Fill(&query.min, -INFINITY, -INFINITY, -INFINITY);
+    kmVec3Fill(&query.max, INFINITY, INFINITY, INFINITY);
+    KM_CHECK(checkQuery(&grid, boxes, &query) == BOX_COUNT);
+
+    kmVec3Fill(&query.min, -1e30f, -1e30f, -1e30f);
+    kmVec3Fill(&query.max, 1e30f, 1e30f, 1e30f);
+    KM_CHECK(checkQuery(&grid, boxes, &query) == BOX_COUNT);
+
+    kmVec3Fill(&query.min, -INFINITY, -2.0f, -INFINITY);
+    kmVec3Fill(&query.max, 0.5f, 1.5f, INFINITY);
+    KM_CHECK(checkQuery(&grid, boxes, &query) > 0);
+
+    /* An unbounded radius finds everything */
+    memset(&visits, 0, sizeof(visits));
+    kmVec3Fill(&centre, 0.0f, 0.0f, 0.0f);
+    kmHashGridQueryRadius(&grid, &centre, INFINITY, visit, &visits);
+    KM_CHECK(visits.total == BOX_COUNT);
+    for(i = 0; i < BOX_COUNT; ++i) {
+        KM_CHECK(visits.counts[i] == 1);
+    }
+
+    kmHashGridRelease(&grid);
+
+    return KM_TEST_RESULT();
+}
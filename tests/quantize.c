@@ -0,0 +1,210 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <kazmath/kazmath.h>
+
+#include "test.h"
+
+/* The bounds documented in quantize.h */
+#define PACK48_BOUND 8e-5f
+#define PACK32_BOUND 2.5e-3f
+#define HALF_RELATIVE_BOUND (1.0f / 2048.0f)
+#define HALF_SUBNORMAL_BOUND (1.0f / 33554432.0f)
+
+static kmScalar randomScalar(void) {
+    return (kmScalar) rand() / (kmScalar) RAND_MAX * 2.0f - 1.0f;
+}
+
+/* Largest component difference, allowing for the result being negated */
+static kmScalar quaternionError(const kmQuaternion* a, const kmQuaternion* b) {
+    kmScalar s = (kmQuaternionDot(a, b) < 0.0f) ? -1.0f : 1.0f;
+    return kmMax(kmMax(fabsf(a->x - s * b->x), fabsf(a->y - s * b->y)),
+                 kmMax(fabsf(a->z - s * b->z), fabsf(a->w - s * b->w)));
+}
+
+static void testQuaternions(void) {
+    kmScalar worst48 = 0.0f, worst32 = 0.0f;
+    int dropped, i;
+
+    for(dropped = 0; dropped < 4; ++dropped) {
+        for(i = 0; i < 2000; ++i) {
+            kmScalar c[4];
+            kmQuaternion q, negated, decoded, decodedNegated;
+            uint16_t packed[3], packedNegated[3];
+            uint32_t packed32;
+            int j;
+
+            /* Make component dropped the largest, including exact ties
+             * with the others and the edge case of a single axis */
+            for(j = 0; j < 4; ++j) {
+                c[j] = (i == 0) ? 0.0f : randomScalar() * 0.5f;
+            }
+            c[dropped] = (i == 1) ? 0.5f : 1.0f;
+            if(i == 1) {
+                c[0] = c[1] = c[2] = c[3] = 0.5f;
+            }
+
+            kmQuaternionFill(&q, c[0], c[1], c[2], c[3]);
+            kmQuaternionNormalize(&q, &q);
+            kmQuaternionScale(&negated, &q, -1.0f);
+
+            kmQuaternionPack48(packed, &q);
+            kmQuaternionPack48(packedNegated, &negated);
+            KM_CHECK(packed[0] == packedNegated[0] && packed[1] == packedNegated[1] && packed[2] == packedNegated[2]);
+            if(i > 1) {
+                KM_CHECK(((packed[0] >> 15) << 1 | (packed[1] >> 15)) == (unsigned) dropped);
+            }
+
+            kmQuaternionUnpack48(&decoded, packed);
+            kmQuaternionUnpack48Array(&decodedNegated, packedNegated, 1);
+            KM_CHECK(quaternionError(&decoded, &decodedNegated) == 0.0f);
+            worst48 = kmMax(worst48, quaternionError(&q, &decoded));
+
+            packed32 = kmQuaternionPack32(&q);
+            KM_CHECK(packed32 == kmQuaternionPack32(&negated));
+            kmQuaternionUnpack32Array(&decoded, &packed32, 1);
+            worst32 = kmMax(worst32, quaternionError(&q, &decoded));
+            kmQuaternionUnpack32(&decodedNegated, packed32);
+            KM_CHECK(quaternionError(&decoded, &decodedNegated) == 0.0f);
+        }
+    }
+
+    printf("pack48 worst %g, pack32 worst %g\n", (double) worst48, (double) worst32);
+    KM_CHECK(worst48 <= PACK48_BOUND);
+    KM_CHECK(worst32 <= PACK32_BOUND);
+}
+
+static void testHalves(void) {
+    kmScalar in[4] = { 1.0f, -2.5f, 65504.0f, 0.0f }, out[4];
+    kmHalf halves[4];
+    uint32_t h;
+    int i;
+
+    /* Every non-NaN half survives a round trip exactly */
+    for(h = 0; h < 0x10000u; ++h) {
+        kmScalar s = kmHalfToScalar((kmHalf) h);
+        if((h & 0x7c00u) == 0x7c00u && (h & 0x03ffu)) {
+            KM_CHECK(isnan(s));
+        } else {
+            KM_CHECK(kmHalfFromScalar(s) == (kmHalf) h);
+        }
+    }
+
+    /* Subnormals are exact multiples of 2^-24 */
+    for(h = 1; h < 0x400u; ++h) {
+        KM_CHECK(kmHalfToScalar((kmHalf) h) == ldexpf((kmScalar) h, -24));
+    }
+    KM_CHECK(kmHalfFromScalar(ldexpf(1.0f, -24)) == 0x0001);
+    KM_CHECK(kmHalfFromScalar(ldexpf(1.0f, -25)) == 0x0000);   /* tie, rounds to even */
+    KM_CHECK(kmHalfFromScalar(ldexpf(3.0f, -25)) == 0x0002);   /* tie, rounds to even */
+    KM_CHECK(kmHalfFromScalar(ldexpf(1.0f, -26)) == 0x0000);
+    KM_CHECK(kmHalfFromScalar(-ldexpf(1.0f, -24)) == 0x8001);
+
+    /* The top of the range and overflow */
+    KM_CHECK(kmHalfFromScalar(65504.0f) == 0x7bff);
+    KM_CHECK(kmHalfFromScalar(65519.0f) == 0x7bff);
+    KM_CHECK(kmHalfFromScalar(65520.0f) == 0x7c00);
+    KM_CHECK(kmHalfFromScalar(-65520.0f) == 0xfc00);
+    KM_CHECK(kmHalfFromScalar(INFINITY) == 0x7c00);
+    KM_CHECK(isinf(kmHalfToScalar(0x7c00)));
+
+    /* NaN stays NaN, signed zero keeps its sign */
+    KM_CHECK((kmHalfFromScalar(NAN) & 0x7c00u) == 0x7c00u && (kmHalfFromScalar(NAN) & 0x03ffu));
+    KM_CHECK(isnan(kmHalfToScalar(0x7e00)));
+    KM_CHECK(kmHalfFromScalar(-0.0f) == 0x8000);
+
+    /* Documented error bounds over the normal and subnormal ranges */
+    for(i = 0; i < 100000; ++i) {
+        kmScalar normal = ldexpf(1.0f + fabsf(randomScalar()), rand() % 29 - 14) * (i & 1 ? -1.0f : 1.0f);
+        kmScalar subnormal = randomScalar() * ldexpf(1.0f, -14);
+        kmScalar n = kmHalfToScalar(kmHalfFromScalar(normal));
+        kmScalar s = kmHalfToScalar(kmHalfFromScalar(subnormal));
+
+        KM_CHECK(fabsf(n - normal) <= fabsf(normal) * HALF_RELATIVE_BOUND);
+        KM_CHECK(fabsf(s - subnormal) <= HALF_SUBNORMAL_BOUND);
+    }
+
+    /* The batch forms match the scalar ones */
+    kmHalfFromScalarArray(halves, in, 4);
+    kmHalfToScalarArray(out, halves, 4);
+    for(i = 0; i < 4; ++i) {
+        KM_CHECK(halves[i] == kmHalfFromScalar(in[i]));
+        KM_CHECK(out[i] == in[i]);
+    }
+}
+
+static void testVectors(void) {
+    kmAABB3 range = { { -3.0f, 0.0f, 10.0f }, { 5.0f, 0.25f, 10.0f } };
+    kmVec3 extent = { 8.0f, 0.25f, 0.0f };
+    uint16_t packed[3 * 4];
+    kmVec3 in[4], out[4];
+    int i;
+
+    /* The corners of the box are representable */
+    kmVec3Quantize16(packed, &range.min, &range);
+    KM_CHECK(packed[0] == 0 && packed[1] == 0 && packed[2] == 0);
+    kmVec3Dequantize16(&out[0], packed, &range);
+    KM_CHECK(kmVec3AreEqual(&out[0], &range.min));
+
+    kmVec3Quantize16(packed, &range.max, &range);
+    KM_CHECK(packed[0] == 65535 && packed[1] == 65535 && packed[2] == 0);
+    kmVec3Dequantize16(&out[0], packed, &range);
+    KM_CHECK_NEAR(out[0].x, range.max.x, 1e-6f);
+    KM_CHECK_NEAR(out[0].y, range.max.y, 1e-7f);
+    KM_CHECK(out[0].z == 10.0f);
+
+    /* Points outside are clamped onto the box */
+    kmVec3Fill(&in[0], -100.0f, 100.0f, 11.0f);
+    kmVec3Quantize16(packed, &in[0], &range);
+    KM_CHECK(packed[0] == 0 && packed[1] == 65535 && packed[2] == 0);
+
+    /* Points inside stay within (max - min) / 131070 per axis */
+    for(i = 0; i < 10000; ++i) {
+        int j = i & 3;
+
+        kmVec3Fill(&in[j], 1.0f + randomScalar() * 4.0f, 0.125f + randomScalar() * 0.125f, 10.0f);
+        kmVec3Quantize16(&packed[j * 3], &in[j], &range);
+
+        if(j == 3) {
+            int k;
+            kmVec3Dequantize16Array(out, packed, &range, 4);
+            for(k = 0; k < 4; ++k) {
+                KM_CHECK(fabsf(out[k].x - in[k].x) <= extent.x / 131070.0f * 1.001f);
+                KM_CHECK(fabsf(out[k].y - in[k].y) <= extent.y / 131070.0f * 1.001f);
+                KM_CHECK(out[k].z == 10.0f);
+            }
+        }
+    }
+}
+
+int main(void) {
+    testQuaternions();
+    testHalves();
+    testVectors();
+    return KM_TEST_RESULT();
+}
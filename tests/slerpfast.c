@@ -0,0 +1,124 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+
+#include <kazmath/kazmath.h>
+
+#include "test.h"
+
+/* The bounds documented for kmQuaternionSlerpFast */
+#define ANGLE_BOUND 2e-5
+#define LENGTH_BOUND 4e-5
+
+#define STEPS 64
+#define ANGLES 512
+
+/*
+ * Angle between the directions of two quaternions as 4D vectors, from
+ * the chord so that it stays well conditioned near zero.
+ */
+static double angleBetween(const kmQuaternion* a, const kmQuaternion* b) {
+    double la = sqrt((double) a->x * a->x + (double) a->y * a->y + (double) a->z * a->z + (double) a->w * a->w);
+    double lb = sqrt((double) b->x * b->x + (double) b->y * b->y + (double) b->z * b->z + (double) b->w * b->w);
+    double dx = a->x / la - b->x / lb, dy = a->y / la - b->y / lb;
+    double dz = a->z / la - b->z / lb, dw = a->w / la - b->w / lb;
+    return 2.0 * asin(fmin(1.0, sqrt(dx * dx + dy * dy + dz * dz + dw * dw) * 0.5));
+}
+
+static double lengthError(const kmQuaternion* q) {
+    return fabs(sqrt((double) q->x * q->x + (double) q->y * q->y + (double) q->z * q->z + (double) q->w * q->w) - 1.0);
+}
+
+int main(void) {
+    static kmScalar x1[STEPS], y1[STEPS], z1[STEPS], w1[STEPS];
+    static kmScalar x2[STEPS], y2[STEPS], z2[STEPS], w2[STEPS];
+    static kmScalar ox[STEPS], oy[STEPS], oz[STEPS], ow[STEPS], ts[STEPS];
+    kmQuaternionSoA a = { x1, y1, z1, w1 }, b = { x2, y2, z2, w2 }, out = { ox, oy, oz, ow };
+    double worstAngle = 0.0, worstLength = 0.0;
+    kmVec3 axis;
+    int i, s;
+
+    kmVec3Fill(&axis, 1.0f, 2.0f, -0.5f);
+    kmVec3Normalize(&axis, &axis);
+
+    /* Sweep the angle between the quaternions (as 4D vectors) over [0, pi] */
+    for(i = 0; i <= ANGLES; ++i) {
+        kmScalar theta = kmPI * (kmScalar) i / ANGLES;
+        kmQuaternion q1, q2, q2Near, rotation;
+
+        kmQuaternionRotationAxisAngle(&q1, &axis, 0.3f);
+        kmQuaternionRotationAxisAngle(&rotation, &KM_VEC3_POS_Y, 2.0f * theta);
+        kmQuaternionMultiply(&q2, &rotation, &q1);
+
+        /* kmQuaternionSlerp does not take the shorter arc by itself */
+        q2Near = q2;
+        if(kmQuaternionDot(&q1, &q2) < 0.0f) {
+            kmQuaternionScale(&q2Near, &q2, -1.0f);
+        }
+
+        for(s = 0; s < STEPS; ++s) {
+            kmScalar t = (kmScalar) s / (STEPS - 1);
+            kmQuaternion fast, reference;
+
+            kmQuaternionSlerpFast(&fast, &q1, &q2, t);
+            kmQuaternionSlerp(&reference, &q1, &q2Near, t);
+            kmQuaternionNormalize(&reference, &reference);
+
+            worstAngle = fmax(worstAngle, angleBetween(&fast, &reference));
+            worstLength = fmax(worstLength, lengthError(&fast));
+
+            x1[s] = q1.x; y1[s] = q1.y; z1[s] = q1.z; w1[s] = q1.w;
+            x2[s] = q2.x; y2[s] = q2.y; z2[s] = q2.z; w2[s] = q2.w;
+            ts[s] = t;
+        }
+
+        /* The batch form must match the scalar one */
+        kmQuaternionSlerpFastArray(&out, &a, &b, ts, 0.0f, STEPS);
+        for(s = 0; s < STEPS; ++s) {
+            kmQuaternion fast, batch;
+
+            kmQuaternionSlerpFast(&fast, &q1, &q2, ts[s]);
+            kmQuaternionFill(&batch, ox[s], oy[s], oz[s], ow[s]);
+            KM_CHECK(angleBetween(&batch, &fast) <= 1e-6);
+            KM_CHECK(lengthError(&batch) <= LENGTH_BOUND);
+        }
+
+        /* And so must the uniform t path */
+        kmQuaternionSlerpFastArray(&out, &a, &b, NULL, 0.25f, STEPS);
+        {
+            kmQuaternion fast, batch;
+            kmQuaternionSlerpFast(&fast, &q1, &q2, 0.25f);
+            kmQuaternionFill(&batch, ox[0], oy[0], oz[0], ow[0]);
+            KM_CHECK(angleBetween(&batch, &fast) <= 1e-6);
+        }
+    }
+
+    printf("slerp fast: worst angle %g rad, worst length error %g\n", worstAngle, worstLength);
+    KM_CHECK(worstAngle <= ANGLE_BOUND);
+    KM_CHECK(worstLength <= LENGTH_BOUND);
+
+    return KM_TEST_RESULT();
+}
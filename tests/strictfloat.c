@@ -0,0 +1,223 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <kazmath/kazmath.h>
+
+#include "test.h"
+
+/*
+ * Compares the single precision kernels against double precision
+ * references of the same formulas. This executable links against a copy
+ * of the library built with the KAZMATH_STRICT_FLOAT warnings, so any
+ * accuracy lost by keeping the kernels in float shows up here.
+ */
+
+#define ROTATION_BOUND 1e-6
+#define SLERP_BOUND 4e-6
+#define INTERSECTION_BOUND 2e-6
+
+static double randomDouble(void) {
+    return (double) rand() / (double) RAND_MAX * 2.0 - 1.0;
+}
+
+static void randomQuaternion(double q[4]) {
+    double length;
+
+    do {
+        q[0] = randomDouble();
+        q[1] = randomDouble();
+        q[2] = randomDouble();
+        q[3] = randomDouble();
+        length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    } while(length < 0.1 || length > 1.0);
+
+    q[0] /= length;
+    q[1] /= length;
+    q[2] /= length;
+    q[3] /= length;
+}
+
+static void toQuaternion(kmQuaternion* pOut, const double q[4]) {
+    kmQuaternionFill(pOut, (kmScalar) q[0], (kmScalar) q[1], (kmScalar) q[2], (kmScalar) q[3]);
+}
+
+/* Reads the float inputs back so both sides start from the same values */
+static void fromQuaternion(double q[4], const kmQuaternion* pIn) {
+    q[0] = pIn->x;
+    q[1] = pIn->y;
+    q[2] = pIn->z;
+    q[3] = pIn->w;
+}
+
+static void testRotationQuaternion(void) {
+    double worst = 0.0;
+    int i, j;
+
+    for(i = 0; i < 100000; ++i) {
+        double q[4], m[9];
+        kmQuaternion quaternion;
+        kmMat4 rotation;
+
+        randomQuaternion(q);
+        toQuaternion(&quaternion, q);
+        fromQuaternion(q, &quaternion);
+        kmMat4RotationQuaternion(&rotation, &quaternion);
+
+        m[0] = 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]);
+        m[1] = 2.0 * (q[0] * q[1] + q[2] * q[3]);
+        m[2] = 2.0 * (q[0] * q[2] - q[1] * q[3]);
+        m[3] = 2.0 * (q[0] * q[1] - q[2] * q[3]);
+        m[4] = 1.0 - 2.0 * (q[0] * q[0] + q[2] * q[2]);
+        m[5] = 2.0 * (q[1] * q[2] + q[0] * q[3]);
+        m[6] = 2.0 * (q[0] * q[2] + q[1] * q[3]);
+        m[7] = 2.0 * (q[1] * q[2] - q[0] * q[3]);
+        m[8] = 1.0 - 2.0 * (q[0] * q[0] + q[1] * q[1]);
+
+        for(j = 0; j < 9; ++j) {
+            worst = fmax(worst, fabs(rotation.mat[(j / 3) * 4 + j % 3] - m[j]));
+        }
+        KM_CHECK(rotation.mat[3] == 0.0f && rotation.mat[7] == 0.0f && rotation.mat[11] == 0.0f);
+        KM_CHECK(rotation.mat[12] == 0.0f && rotation.mat[13] == 0.0f && rotation.mat[14] == 0.0f);
+        KM_CHECK(rotation.mat[15] == 1.0f);
+    }
+
+    printf("kmMat4RotationQuaternion worst %g\n", worst);
+    KM_CHECK(worst <= ROTATION_BOUND);
+}
+
+static void testSlerp(void) {
+    double worst = 0.0;
+    int i, j;
+
+    for(i = 0; i < 100000; ++i) {
+        double a[4], b[4], r[4], dot, theta, s1, s2;
+        double t = (double) (i % 17) / 16.0;
+        kmQuaternion q1, q2, result;
+
+        randomQuaternion(a);
+        randomQuaternion(b);
+        toQuaternion(&q1, a);
+        toQuaternion(&q2, b);
+        fromQuaternion(a, &q1);
+        fromQuaternion(b, &q2);
+
+        dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+
+        /* The float kernel's orthogonal construction loses precision
+         * approaching the antipode, which no precision fixes */
+        if(dot < -0.99) {
+            continue;
+        }
+
+        kmQuaternionSlerp(&result, &q1, &q2, (kmScalar) t);
+
+        theta = acos(fmin(fmax(dot, -1.0), 1.0));
+        if(sin(theta) < 1e-9) {
+            continue;
+        }
+        s1 = sin((1.0 - t) * theta) / sin(theta);
+        s2 = sin(t * theta) / sin(theta);
+        for(j = 0; j < 4; ++j) {
+            r[j] = s1 * a[j] + s2 * b[j];
+        }
+
+        worst = fmax(worst, fabs(result.x - r[0]));
+        worst = fmax(worst, fabs(result.y - r[1]));
+        worst = fmax(worst, fabs(result.z - r[2]));
+        worst = fmax(worst, fabs(result.w - r[3]));
+    }
+
+    printf("kmQuaternionSlerp worst %g\n", worst);
+    KM_CHECK(worst <= SLERP_BOUND);
+}
+
+static void testPlaneIntersection(void) {
+    double worst = 0.0;
+    int i, tested = 0;
+
+    for(i = 0; i < 100000; ++i) {
+        double n[3][3], d[3], c[3][3], denom, p[3], scale;
+        kmPlane planes[3];
+        kmVec3 point;
+        int j, k;
+
+        for(j = 0; j < 3; ++j) {
+            for(k = 0; k < 3; ++k) {
+                n[j][k] = randomDouble();
+            }
+            d[j] = randomDouble() * 10.0;
+            kmPlaneFill(&planes[j], (kmScalar) n[j][0], (kmScalar) n[j][1],
+                        (kmScalar) n[j][2], (kmScalar) d[j]);
+            n[j][0] = planes[j].a;
+            n[j][1] = planes[j].b;
+            n[j][2] = planes[j].c;
+            d[j] = planes[j].d;
+        }
+
+        /* c[j] is the cross product of the other two normals in order */
+        for(j = 0; j < 3; ++j) {
+            const double* u = n[(j + 1) % 3];
+            const double* v = n[(j + 2) % 3];
+            c[j][0] = u[1] * v[2] - u[2] * v[1];
+            c[j][1] = u[2] * v[0] - u[0] * v[2];
+            c[j][2] = u[0] * v[1] - u[1] * v[0];
+        }
+        denom = n[0][0] * c[0][0] + n[0][1] * c[0][1] + n[0][2] * c[0][2];
+
+        /* Only compare well conditioned systems */
+        if(fabs(denom) < 0.25) {
+            continue;
+        }
+
+        KM_CHECK(kmPlaneGetIntersection(&point, &planes[0], &planes[1], &planes[2]) == &point);
+        ++tested;
+
+        /* Solve n . p + d = 0 for each plane */
+        scale = 0.0;
+        for(k = 0; k < 3; ++k) {
+            p[k] = -(d[0] * c[0][k] + d[1] * c[1][k] + d[2] * c[2][k]) / denom;
+            scale = fmax(scale, fabs(p[k]));
+        }
+        scale = fmax(scale, 1.0);
+
+        worst = fmax(worst, fabs(point.x - p[0]) / scale);
+        worst = fmax(worst, fabs(point.y - p[1]) / scale);
+        worst = fmax(worst, fabs(point.z - p[2]) / scale);
+    }
+
+    printf("kmPlaneGetIntersection worst %g over %d systems\n", worst, tested);
+    KM_CHECK(tested > 1000);
+    KM_CHECK(worst <= INTERSECTION_BOUND);
+}
+
+int main(void) {
+    testRotationQuaternion();
+    testSlerp();
+    testPlaneIntersection();
+    return KM_TEST_RESULT();
+}
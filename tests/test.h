@@ -0,0 +1,58 @@
+/*
+Copyright (c) 2008, Luke Benstead.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KAZMATH_TEST_H_INCLUDED
+#define KAZMATH_TEST_H_INCLUDED
+
+#include <stdio.h>
+
+/*
+ * Minimal checks for the test executables. Each failed check is
+ * reported and counted, and main returns KM_TEST_RESULT() so that
+ * CTest sees the failure.
+ */
+static int kmTestFailures = 0;
+
+#define KM_CHECK(cond) \
+    do { \
+        if(!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++kmTestFailures; \
+        } \
+    } while(0)
+
+#define KM_CHECK_NEAR(a, b, tolerance) \
+    do { \
+        double km_a_ = (double) (a), km_b_ = (double) (b); \
+        if(!(fabs(km_a_ - km_b_) <= (double) (tolerance))) { \
+            fprintf(stderr, "%s:%d: check failed: %s = %g, %s = %g (tolerance %g)\n", \
+                    __FILE__, __LINE__, #a, km_a_, #b, km_b_, (double) (tolerance)); \
+            ++kmTestFailures; \
+        } \
+    } while(0)
+
+#define KM_TEST_RESULT() (kmTestFailures ? 1 : 0)
+
+#endif /* KAZMATH_TEST_H_INCLUDED */